@@ -0,0 +1,135 @@
+#include "AttackTables.h"
+
+using namespace chessengine;
+
+typedef AttackTables::SquareTable SquareTable;
+typedef AttackTables::SquarePairTable SquarePairTable;
+
+// File and rank offsets of the ray directions (north, north-east, ... north-west).
+static constexpr int DIRECTION_STEP[8][2] = { { 0, 1 }, { 1, 1 }, { 1, 0 }, { 1, -1 }, { 0, -1 }, { -1, -1 }, { -1, 0 }, { -1, 1 } };
+
+static constexpr int KNIGHT_STEP[8][2] = { { 1, 2 }, { 2, 1 }, { 2, -1 }, { 1, -2 }, { -1, -2 }, { -2, -1 }, { -2, 1 }, { -1, 2 } };
+
+// Mask of the square offset from pos by (df, dr), or 0 if that square is off the board.
+static constexpr uint64_t stepMask(const int pos, const int df, const int dr)
+{
+	return (pos % 8 + df >= 0 && pos % 8 + df < 8 && pos / 8 + dr >= 0 && pos / 8 + dr < 8)
+		? 1ui64 << ((pos / 8 + dr) * 8 + pos % 8 + df)
+		: 0;
+}
+
+static constexpr SquareTable generateKnight()
+{
+	SquareTable table = {};
+	for (int pos = 0; pos < 64; pos++)
+		for (int i = 0; i < 8; i++)
+			table.mask[pos] |= stepMask(pos, KNIGHT_STEP[i][0], KNIGHT_STEP[i][1]);
+	return table;
+}
+
+static constexpr SquareTable generateKing()
+{
+	SquareTable table = {};
+	for (int pos = 0; pos < 64; pos++)
+		for (int i = 0; i < 8; i++)
+			table.mask[pos] |= stepMask(pos, DIRECTION_STEP[i][0], DIRECTION_STEP[i][1]);
+	return table;
+}
+
+static constexpr SquareTable generatePawn(const int forward)
+{
+	SquareTable table = {};
+	for (int pos = 0; pos < 64; pos++)
+		table.mask[pos] = stepMask(pos, -1, forward) | stepMask(pos, 1, forward);
+	return table;
+}
+
+static constexpr uint64_t ray(const int pos, const int dir)
+{
+	uint64_t mask = 0;
+	int f = pos % 8 + DIRECTION_STEP[dir][0];
+	int r = pos / 8 + DIRECTION_STEP[dir][1];
+	while (f >= 0 && f < 8 && r >= 0 && r < 8)
+	{
+		mask |= 1ui64 << (r * 8 + f);
+		f += DIRECTION_STEP[dir][0];
+		r += DIRECTION_STEP[dir][1];
+	}
+	return mask;
+}
+
+static constexpr SquareTable generateRay(const int dir)
+{
+	SquareTable table = {};
+	for (int pos = 0; pos < 64; pos++)
+		table.mask[pos] = ray(pos, dir);
+	return table;
+}
+
+// Direction from a to b, or -1 if the squares are not on a common rank, file or diagonal.
+static constexpr int direction(const int a, const int b)
+{
+	const int df = b % 8 - a % 8;
+	const int dr = b / 8 - a / 8;
+
+	if (a == b || (df != 0 && dr != 0 && df != dr && df != -dr))
+		return -1;
+
+	for (int dir = 0; dir < 8; dir++)
+	{
+		const int sf = DIRECTION_STEP[dir][0];
+		const int sr = DIRECTION_STEP[dir][1];
+		if (sf == (df > 0) - (df < 0) && sr == (dr > 0) - (dr < 0))
+			return dir;
+	}
+	return -1;
+}
+
+static constexpr SquarePairTable generateBetween()
+{
+	SquarePairTable table = {};
+	for (int a = 0; a < 64; a++)
+	{
+		for (int b = 0; b < 64; b++)
+		{
+			const int dir = direction(a, b);
+			if (dir >= 0)
+				table.mask[a][b] = ray(a, dir) & ray(b, (dir + 4) % 8);
+		}
+	}
+	return table;
+}
+
+static constexpr SquarePairTable generateLine()
+{
+	SquarePairTable table = {};
+	for (int a = 0; a < 64; a++)
+	{
+		for (int b = 0; b < 64; b++)
+		{
+			const int dir = direction(a, b);
+			if (dir >= 0)
+				table.mask[a][b] = ray(a, dir) | ray(a, (dir + 4) % 8) | 1ui64 << a;
+		}
+	}
+	return table;
+}
+
+// Evaluating the generators into constexpr objects forces compile-time evaluation.
+static constexpr SquareTable KNIGHT_TABLE = generateKnight();
+static constexpr SquareTable KING_TABLE = generateKing();
+static constexpr SquareTable WHITE_PAWN_TABLE = generatePawn(1);
+static constexpr SquareTable BLACK_PAWN_TABLE = generatePawn(-1);
+static constexpr SquarePairTable BETWEEN_TABLE = generateBetween();
+static constexpr SquarePairTable LINE_TABLE = generateLine();
+
+const SquareTable AttackTables::KNIGHT = KNIGHT_TABLE;
+const SquareTable AttackTables::KING = KING_TABLE;
+const SquareTable AttackTables::PAWN[2] = { WHITE_PAWN_TABLE, BLACK_PAWN_TABLE };
+const SquareTable AttackTables::RAY[8] =
+{
+	generateRay(NORTH), generateRay(NORTH_EAST), generateRay(EAST), generateRay(SOUTH_EAST),
+	generateRay(SOUTH), generateRay(SOUTH_WEST), generateRay(WEST), generateRay(NORTH_WEST)
+};
+const SquarePairTable AttackTables::BETWEEN = BETWEEN_TABLE;
+const SquarePairTable AttackTables::LINE = LINE_TABLE;
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include "Board.h"
+
+namespace chessengine
+{
+
+	// Attack and geometry tables generated at compile time.
+	// All tables are constant initialized, so they are part of the binary image and need no setup at startup.
+	class AttackTables
+	{
+
+	public:
+
+		// Ray directions
+
+		static const unsigned int NORTH = 0;
+		static const unsigned int NORTH_EAST = 1;
+		static const unsigned int EAST = 2;
+		static const unsigned int SOUTH_EAST = 3;
+		static const unsigned int SOUTH = 4;
+		static const unsigned int SOUTH_WEST = 5;
+		static const unsigned int WEST = 6;
+		static const unsigned int NORTH_WEST = 7;
+
+		// A mask for every square.
+		struct SquareTable
+		{
+			uint64_t mask[64];
+			constexpr uint64_t operator[](const piece_p pos) const { return mask[pos]; }
+		};
+
+		// A mask for every pair of squares.
+		struct SquarePairTable
+		{
+			uint64_t mask[64][64];
+			constexpr const uint64_t (&operator[](const piece_p pos) const)[64] { return mask[pos]; }
+		};
+
+		static const SquareTable KNIGHT;		// Knight attacks.
+		static const SquareTable KING;			// King attacks.
+		static const SquareTable PAWN[2];		// Pawn captures, indexed by color / Board::BLACK.
+		static const SquareTable RAY[8];		// Squares from (excluding) a square to the board edge, indexed by direction.
+		static const SquarePairTable BETWEEN;	// Squares strictly between two aligned squares, 0 if not aligned.
+		static const SquarePairTable LINE;		// The full board line through two aligned squares, 0 if not aligned.
+
+		// Squares attacked by a pawn of the given color.
+		static inline uint64_t pawn(const piece_p pos, const color color)
+		{
+			return PAWN[color / Board::BLACK][pos];
+		}
+
+	};
+
+}
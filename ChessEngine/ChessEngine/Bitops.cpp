@@ -36,43 +36,6 @@ void rotl64(uint64_t &mask, const unsigned int &places)
 	mask = (mask << p) | (mask >> (-p & 63));
 }
 
-// Returns a pointer to a table containing the indices of all set bits in a 64-bit mask.
-uint8_t *bit_i(uint64_t mask, unsigned int &count)
-{
-	unsigned long long popcnt = bitcount(mask);
-	uint8_t *outPtr = new uint8_t[popcnt];
-	unsigned long index = 0;
-	unsigned int n = 0;
-
-	while (mask)
-	{
-		_BitScanForward64(&index, mask);
-		outPtr[n++] = (uint8_t)index;
-		mask &= mask - 1;
-	}
-
-	count = (unsigned int)popcnt;
-	return outPtr;
-}
-
-// Returns a vector containing the indices of all set bits in a 64-bit mask.
-std::vector<unsigned long> bit_i(uint64_t mask)
-{
-	std::vector<unsigned long> vec;
-	vec.resize(bitcount(mask));
-
-	unsigned long index;
-	unsigned int n = 0;
-	while (mask)
-	{
-		_BitScanForward64(&index, mask);
-		vec[n++] = index;
-		mask &= mask - 1;
-	}
-
-	return vec;
-}
-
 // Returns the number of set bits in a 64-bit mask.
 unsigned long bitcount(uint64_t mask)
 {
@@ -1,6 +1,6 @@
 #pragma once
 #include <cstdint>
-#include <vector>
+#include <intrin.h>
 
 const uint8_t bitReverseTable8[256] =
 {
@@ -26,6 +26,13 @@ void reverseBits64(uint64_t &);
 void reverseBits8(uint8_t &);
 void rotr64(uint64_t &, const unsigned int &);
 void rotl64(uint64_t &, const unsigned int &);
-uint8_t *bit_i(uint64_t mask, unsigned int &count);
-std::vector<unsigned long> bit_i(uint64_t mask);
-unsigned long bitcount(uint64_t mask);
\ No newline at end of file
+unsigned long bitcount(uint64_t mask);
+
+// Returns the index of the least significant set bit of a non-zero mask and clears it.
+inline uint8_t popLSB(uint64_t &mask)
+{
+	unsigned long index;
+	_BitScanForward64(&index, mask);
+	mask &= mask - 1;
+	return (uint8_t)index;
+}
\ No newline at end of file
@@ -1,19 +1,39 @@
 #include "Board.h"
 #include "Bitops.h"
-#include "MoveGenerator.h"
+#include "SlidingAttacks.h"
+#include "AttackTables.h"
+#include "PieceSquareTables.h"
 #include <intrin.h>
+#include <assert.h>
 
 using namespace chessengine;
 
-const unsigned int Board::PIECE_VALUE[6] = { 1, 5, 3, 3, 9, 0 };
+const unsigned int Board::PIECE_VALUE[6] = { 100, 500, 300, 300, 900, 0 };
 const std::string Board::PIECE_NAME[6] = { "PAWN", "ROOK", "KNIGHT", "BISHOP", "QUEEN", "KING" };
 
+// Castling rights lost when a piece moves from or to a square: moving the king or a rook, or capturing a rook.
+static inline uint8_t castlingLost(const piece_p pos)
+{
+	switch (pos)
+	{
+	case 0: return Board::WHITE_QUEENSIDE;
+	case 4: return Board::WHITE_KINGSIDE | Board::WHITE_QUEENSIDE;
+	case 7: return Board::WHITE_KINGSIDE;
+	case 56: return Board::BLACK_QUEENSIDE;
+	case 60: return Board::BLACK_KINGSIDE | Board::BLACK_QUEENSIDE;
+	case 63: return Board::BLACK_KINGSIDE;
+	}
+	return 0;
+}
+
 Board::Board()
+	: castling(0), enPassant(NO_SQUARE), halfmoves(0), historySize(0)
 {
 	for (unsigned int i = 0; i < Board::NUM_OF_BITBOARDS; i++)
 	{
 		bitboard[i] = 0; // init to 0
 	}
+	refresh();
 }
 
 
@@ -149,319 +169,342 @@ void Board::init()
 	// Kings
 	bitboard[WHITE + KING] = shiftToRankCopy(KING_RANK_VAL, RANK_1);
 	bitboard[BLACK + KING] = shiftToRankCopy(KING_RANK_VAL, RANK_8);
+
+	castling = ALL_CASTLING;
+	enPassant = NO_SQUARE;
+	halfmoves = 0;
+	historySize = 0;
+
+	refresh();
 }
 
-// Creates a mask marking occupied squares on the board.
-uint64_t Board::positionMask() const
+// Rebuilds the occupancy masks, the mailbox, the keys and the evaluation terms from the bitboards.
+void Board::refresh()
 {
-	uint64_t mask = 0;
-	for (piece_t i = PAWN; i <= KING; i++)
+	occupancy = 0;
+	colorOccupancy[0] = 0;
+	colorOccupancy[1] = 0;
+	key = 0;
+	pawnKey = 0;
+	midgame = 0;
+	endgame = 0;
+	phase = 0;
+
+	for (piece_p pos = 0; pos < 64; pos++)
 	{
-		mask |= bitboard[i + WHITE];
-		mask |= bitboard[i + BLACK];
+		mailbox[pos] = EMPTY;
 	}
-	return mask;
-}
 
-// Creates a mask marking occupied squares on the board by a specific color.
-uint64_t Board::colorPositionMask(const color &color) const
-{
-	uint64_t mask = 0;
-	for (piece_t i = PAWN; i <= KING; i++)
+	for (int8_t piece = 0; piece < (int8_t)NUM_OF_BITBOARDS; piece++)
 	{
-		mask |= bitboard[i + color];
+		colorOccupancy[piece / BLACK] |= bitboard[piece];
+
+		uint64_t mask = bitboard[piece];
+		unsigned long index;
+		while (_BitScanForward64(&index, mask))
+		{
+			mailbox[index] = piece;
+			key ^= Zobrist::KEYS.piece[piece][index];
+			if (piece == WHITE + PAWN || piece == BLACK + PAWN)
+				pawnKey ^= Zobrist::KEYS.piece[piece][index];
+			midgame += PieceSquareTables::MIDGAME[piece][index];
+			endgame += PieceSquareTables::ENDGAME[piece][index];
+			phase += PieceSquareTables::PHASE[piece];
+			mask &= mask - 1;
+		}
 	}
-	return mask;
+
+	occupancy = colorOccupancy[0] | colorOccupancy[1];
+
+	key ^= Zobrist::KEYS.castling[castling];
+	if (enPassant != NO_SQUARE)
+		key ^= Zobrist::KEYS.enPassant[enPassant % 8];
 }
 
-// Retrieves the color of the piece at a given position.
-color Board::pieceColor(const uint64_t &posmask) const
+// Places a piece on an empty square.
+void Board::addPiece(const piece_p pos, const int8_t piece)
 {
-	for (piece_t i = PAWN; i <= KING; i++)
-	{
-		if (bitboard[i + WHITE] & posmask) return WHITE;
-		if (bitboard[i + BLACK] & posmask) return BLACK;
-	}
-	return -1;
+	const uint64_t posMask = 1ui64 << pos;
+	bitboard[piece] |= posMask;
+	colorOccupancy[piece / BLACK] |= posMask;
+	occupancy |= posMask;
+	mailbox[pos] = piece;
+	key ^= Zobrist::KEYS.piece[piece][pos];
+	if (piece == WHITE + PAWN || piece == BLACK + PAWN)
+		pawnKey ^= Zobrist::KEYS.piece[piece][pos];
+	midgame += PieceSquareTables::MIDGAME[piece][pos];
+	endgame += PieceSquareTables::ENDGAME[piece][pos];
+	phase += PieceSquareTables::PHASE[piece];
 }
 
+// Removes the piece from an occupied square.
+void Board::removePiece(const piece_p pos)
+{
+	const uint64_t clearMask = ~(1ui64 << pos);
+	const int8_t piece = mailbox[pos];
+	bitboard[piece] &= clearMask;
+	colorOccupancy[piece / BLACK] &= clearMask;
+	occupancy &= clearMask;
+	mailbox[pos] = EMPTY;
+	key ^= Zobrist::KEYS.piece[piece][pos];
+	if (piece == WHITE + PAWN || piece == BLACK + PAWN)
+		pawnKey ^= Zobrist::KEYS.piece[piece][pos];
+	midgame -= PieceSquareTables::MIDGAME[piece][pos];
+	endgame -= PieceSquareTables::ENDGAME[piece][pos];
+	phase -= PieceSquareTables::PHASE[piece];
+}
 
-void Board::movePiece(const piece_p pos, const piece_t type, const color color, const piece_p dest)
+// Performs a move of the given color without recording it.
+void Board::movePiece(const Move move, const color color)
 {
-	bitboard[color + type] &= ~(1ui64 << pos);	// clear pos square
-	clearSquare(dest);	// clear dest square
+	const piece_p pos = move.pos();
+	const piece_p dest = move.dest();
+	const int8_t piece = mailbox[pos];
+
+	key ^= Zobrist::KEYS.castling[castling];
+	if (enPassant != NO_SQUARE)
+		key ^= Zobrist::KEYS.enPassant[enPassant % 8];
+	enPassant = NO_SQUARE;
 
-	piece_t t = type;
+	removePiece(pos);
 
-	if (type == PAWN)
+	switch (move.kind())
 	{
-		if (
-			(color == WHITE && (dest / 8 == RANK_8))
-			||
-			(color == BLACK && (dest / 8 == RANK_1))
-			)
+	case Move::PROMOTION:
+		clearSquare(dest);
+		addPiece(dest, color + move.promotion());
+		break;
+
+	case Move::EN_PASSANT:
+		// the captured pawn is behind the destination
+		removePiece(color == WHITE ? dest - 8 : dest + 8);
+		addPiece(dest, piece);
+		break;
+
+	case Move::CASTLING:
+		// the rook jumps over the king
+		if (dest > pos)
 		{
-			t = QUEEN;
+			removePiece(pos + 3);
+			addPiece(pos + 1, color + ROOK);
 		}
-	}
+		else
+		{
+			removePiece(pos - 4);
+			addPiece(pos - 1, color + ROOK);
+		}
+		addPiece(dest, piece);
+		break;
 
-	bitboard[color + t] |= 1ui64 << dest;
-}
+	default:
+		clearSquare(dest);
+		addPiece(dest, piece);
 
+		// A double pawn push allows en passant if an enemy pawn can capture on the skipped square.
+		if (piece % BLACK == PAWN && (pos ^ dest) == 16)
+		{
+			const piece_p skipped = (pos + dest) / 2;
+			if (AttackTables::pawn(skipped, color) & bitboard[(color ^ BLACK) + PAWN])
+				enPassant = skipped;
+		}
+	}
 
-void Board::setSquare(const piece_p pos, const piece_t type, const color color)
-{
-	clearSquare(pos);
-	bitboard[type + color] |= 1ui64 << pos;
-}
+	castling &= ~(castlingLost(pos) | castlingLost(dest));
 
+	key ^= Zobrist::KEYS.castling[castling];
+	if (enPassant != NO_SQUARE)
+		key ^= Zobrist::KEYS.enPassant[enPassant % 8];
+}
 
-void Board::clearSquare(const piece_p pos)
+// Performs a move and pushes an undo record, so that the move can be taken back with unmakeMove.
+void Board::makeMove(const Move move, const color color)
 {
-	uint64_t clearMask = ~(1ui64 << pos);
-	for (size_t i = 0; i < NUM_OF_BITBOARDS; i++)
-	{
-		bitboard[i] &= clearMask;
-	}
+	assert(historySize < MAX_HISTORY);
+	Undo &undo = history[historySize++];
+	undo.key = key;
+	undo.move = move;
+	undo.piece = mailbox[move.pos()];
+	undo.captured = move.kind() == Move::EN_PASSANT ? (color ^ BLACK) + PAWN : mailbox[move.dest()];
+	undo.castling = castling;
+	undo.enPassant = enPassant;
+	undo.halfmoves = halfmoves;
+
+	halfmoves = undo.captured != EMPTY || undo.piece == color + PAWN ? 0 : halfmoves + 1;
+	movePiece(move, color);
 }
 
-
-bool chessengine::Board::isKingCheck(const color col) const
+// Takes back the last move made with makeMove.
+void Board::unmakeMove()
 {
-	const uint64_t kingPosMask = bitboard[col + KING];
-	const uint64_t pieceMask = positionMask();
-	const color enemyColor = col ^ BLACK;
-	const uint64_t enemyPieces = colorPositionMask(enemyColor);
-	uint64_t checkMask = kingPosMask;
-	piece_p kingPos;
+	const Undo &undo = history[--historySize];
+	const piece_p pos = undo.move.pos();
+	const piece_p dest = undo.move.dest();
 
-	unsigned long index;
-	_BitScanForward64(&index, kingPosMask);
-	kingPos = (piece_p)index;
-	
-	// north
-	checkMask <<= 8;
-	while (checkMask)
+	removePiece(dest);
+	addPiece(pos, undo.piece);
+
+	switch (undo.move.kind())
 	{
-		if (checkMask & pieceMask)
+	case Move::EN_PASSANT:
+		addPiece(undo.piece < BLACK ? dest - 8 : dest + 8, undo.captured);
+		break;
+
+	case Move::CASTLING:
+		if (dest > pos)
 		{
-			if ((checkMask & enemyPieces) &&
-				(checkMask & (bitboard[enemyColor + ROOK] | bitboard[enemyColor + QUEEN]))
-				)
-			{
-				return true;
-			}
-			else
-			{
-				break;
-			}
+			removePiece(pos + 1);
+			addPiece(pos + 3, undo.piece - KING + ROOK);
 		}
-		checkMask <<= 8;
-	}
-
-	// east
-	checkMask = kingPosMask << 1;
-	for (int i = 7 - kingPos % 8; i > 0; i--)
-	{
-		if (checkMask & pieceMask)
+		else
 		{
-			if ((checkMask & enemyPieces) &&
-				(checkMask & (bitboard[enemyColor + ROOK] | bitboard[enemyColor + QUEEN]))
-				)
-			{
-				return true;
-			}
-			else
-			{
-				break;
-			}
+			removePiece(pos - 1);
+			addPiece(pos - 4, undo.piece - KING + ROOK);
 		}
-		checkMask <<= 1;
+		break;
+
+	default:
+		if (undo.captured != EMPTY)
+			addPiece(dest, undo.captured);
 	}
 
-	// south
-	checkMask = kingPosMask >> 8;
-	while (checkMask)
+	castling = undo.castling;
+	enPassant = undo.enPassant;
+	halfmoves = undo.halfmoves;
+	key = undo.key;
+}
+
+// Drops the undo records of the moves before the last capture or pawn move, and of the moves more than 100 plies
+// back, where the fifty-move rule has already drawn the game. Repetitions of those positions do not matter, so this
+// keeps the repetition history of a long game within MAX_HISTORY. The dropped moves cannot be taken back.
+void Board::trimHistory()
+{
+	unsigned int keep = halfmoves < historySize ? halfmoves : historySize;
+	if (keep > 100)
+		keep = 100;
+
+	const unsigned int first = historySize - keep;
+
+	for (unsigned int i = 0; i < keep; i++)
 	{
-		if (checkMask & pieceMask)
-		{
-			if ((checkMask & enemyPieces) &&
-				(checkMask & (bitboard[enemyColor + ROOK] | bitboard[enemyColor + QUEEN]))
-				)
-			{
-				return true;
-			}
-			else
-			{
-				break;
-			}
-		}
-		checkMask >>= 8;
+		history[i] = history[first + i];
 	}
 
-	// west
-	checkMask = kingPosMask >> 1;
-	for (int i = kingPos % 8; i > 0; i--)
+	historySize = keep;
+}
+
+// True if the position occurred before since the last capture or pawn move, with the same side to move. Those
+// positions are every second one back from the current, and the first that can be equal is four plies back.
+bool Board::isRepetition() const
+{
+	const unsigned int reversible = halfmoves < historySize ? halfmoves : historySize;
+
+	for (unsigned int distance = 4; distance <= reversible; distance += 2)
 	{
-		if (checkMask & pieceMask)
-		{
-			if ((checkMask & enemyPieces) &&
-				(checkMask & (bitboard[enemyColor + ROOK] | bitboard[enemyColor + QUEEN]))
-				)
-			{
-				return true;
-			}
-			else
-			{
-				break;
-			}
-		}
-		checkMask >>= 1;
+		if (history[historySize - distance].key == key)
+			return true;
 	}
 
-	// diagonal north east
-	checkMask = kingPosMask << 9;
-	for (int i = 7 - kingPos % 8; i > 0; i--)
-	{
-		if (!checkMask)
-		{
-			break;
-		}
+	return false;
+}
 
-		if (checkMask & pieceMask)
-		{
-			if ((checkMask & enemyPieces) &&
-				(checkMask & (bitboard[enemyColor + BISHOP] | bitboard[enemyColor + QUEEN]))
-				)
-			{
-				return true;
-			}
-			else
-			{
-				break;
-			}
-		}
-		checkMask <<= 9;
-	}
 
-	// diagonal north west
-	checkMask = kingPosMask << 7;
-	for (int i = kingPos % 8; i > 0; i--)
-	{
-		if (!checkMask)
-		{
-			break;
-		}
+void Board::setSquare(const piece_p pos, const piece_t type, const color color)
+{
+	clearSquare(pos);
+	addPiece(pos, type + color);
+}
 
-		if (checkMask & pieceMask)
-		{
-			if ((checkMask & enemyPieces) &&
-				(checkMask & (bitboard[enemyColor + BISHOP] | bitboard[enemyColor + QUEEN]))
-				)
-			{
-				return true;
-			}
-			else
-			{
-				break;
-			}
-		}
-		checkMask <<= 7;
-	}
 
-	// diagonal south east
-	checkMask = kingPosMask >> 7;
-	for (int i = 7 - kingPos % 8; i > 0; i--)
+void Board::clearSquare(const piece_p pos)
+{
+	if (mailbox[pos] != EMPTY)
 	{
-		if (!checkMask)
-		{
-			break;
-		}
-
-		if (checkMask & pieceMask)
-		{
-			if ((checkMask & enemyPieces) &&
-				(checkMask & (bitboard[enemyColor + BISHOP] | bitboard[enemyColor + QUEEN]))
-				)
-			{
-				return true;
-			}
-			else
-			{
-				break;
-			}
-		}
-		checkMask >>= 7;
+		removePiece(pos);
 	}
+}
 
-	// diagonal south west
-	checkMask = kingPosMask >> 9;
-	for (int i = kingPos % 8; i > 0; i--)
-	{
-		if (!checkMask)
-		{
-			break;
-		}
 
-		if (checkMask & pieceMask)
+void Board::setCastlingRights(const uint8_t rights)
+{
+	key ^= Zobrist::KEYS.castling[castling];
+	castling = rights & ALL_CASTLING;
+	key ^= Zobrist::KEYS.castling[castling];
+}
+
+// Sets the square a pawn that just made a double push has skipped. Like after makeMove, the square is only
+// kept if an enemy pawn can capture on it, so that equal positions have equal keys.
+void Board::setEnPassant(const piece_p pos)
+{
+	if (enPassant != NO_SQUARE)
+		key ^= Zobrist::KEYS.enPassant[enPassant % 8];
+
+	enPassant = NO_SQUARE;
+
+	if (pos != NO_SQUARE)
+	{
+		const color pusher = pos / 8 == RANK_3 ? WHITE : BLACK;
+		if (AttackTables::pawn(pos, pusher) & bitboard[(pusher ^ BLACK) + PAWN])
 		{
-			if ((checkMask & enemyPieces) &&
-				(checkMask & (bitboard[enemyColor + BISHOP] | bitboard[enemyColor + QUEEN]))
-				)
-			{
-				return true;
-			}
-			else
-			{
-				break;
-			}
+			enPassant = pos;
+			key ^= Zobrist::KEYS.enPassant[enPassant % 8];
 		}
-		checkMask >>= 9;
 	}
+}
 
-	// knight check
-	if (MoveGenerator::knight(kingPos) & bitboard[enemyColor + KNIGHT])
+
+void Board::setHalfmoveClock(const unsigned int clock)
+{
+	halfmoves = (uint16_t)clock;
+}
+
+// Pieces of the attacker color that attack the square, with the sliders blocked by the given occupancy.
+uint64_t Board::attackers(const piece_p pos, const color attacker, const uint64_t occupancy) const
+{
+	const uint64_t queens = bitboard[attacker + QUEEN];
+
+	return (SlidingAttacks::rook(pos, occupancy) & (bitboard[attacker + ROOK] | queens))
+		| (SlidingAttacks::bishop(pos, occupancy) & (bitboard[attacker + BISHOP] | queens))
+		| (AttackTables::KNIGHT[pos] & bitboard[attacker + KNIGHT])
+		| (AttackTables::KING[pos] & bitboard[attacker + KING])
+		| (AttackTables::pawn(pos, attacker ^ BLACK) & bitboard[attacker + PAWN]);
+}
+
+// True if a piece of the attacker color attacks the square.
+bool Board::isSquareAttacked(const piece_p pos, const color attacker) const
+{
+	// rook and queen
+	if (SlidingAttacks::rook(pos, occupancy) & (bitboard[attacker + ROOK] | bitboard[attacker + QUEEN]))
 	{
 		return true;
 	}
 
-	// king check
-	if (MoveGenerator::king(kingPos) & bitboard[enemyColor + KING])
+	// bishop and queen
+	if (SlidingAttacks::bishop(pos, occupancy) & (bitboard[attacker + BISHOP] | bitboard[attacker + QUEEN]))
 	{
 		return true;
 	}
 
-	// pawn check
-	checkMask = 0ui64;
-	file f = kingPos % 8;
-	if (col == WHITE)
+	// knight
+	if (AttackTables::KNIGHT[pos] & bitboard[attacker + KNIGHT])
 	{
-		if (f != A_FILE) checkMask |= kingPosMask << 7; 
-		if (f != H_FILE) checkMask |= kingPosMask << 9;
-		if (checkMask & bitboard[BLACK + PAWN]) return true;
+		return true;
 	}
-	else
+
+	// king
+	if (AttackTables::KING[pos] & bitboard[attacker + KING])
 	{
-		if (f != A_FILE) checkMask |= kingPosMask >> 9;
-		if (f != H_FILE) checkMask |= kingPosMask >> 7;
-		if (checkMask & bitboard[WHITE + PAWN]) return true;
+		return true;
 	}
 
-	return false;
+	// pawn, found from the squares a pawn of the other color would attack
+	return (AttackTables::pawn(pos, attacker ^ BLACK) & bitboard[attacker + PAWN]) != 0;
 }
 
 
-piece_t chessengine::Board::pieceType(const piece_p pos) const
+bool chessengine::Board::isKingCheck(const color col) const
 {
-	uint64_t posMask = 1ui64 << pos;
-
-	for (piece_t t = PAWN; t <= KING; t++) {
-		if ((bitboard[WHITE + t] & posMask) != 0
-			||
-			(bitboard[BLACK + t] & posMask) != 0) {
-			return t;
-		}
-	}
+	unsigned long index;
+	_BitScanForward64(&index, bitboard[col + KING]);
 
-	return -1;
-}
+	return isSquareAttacked((piece_p)index, col ^ BLACK);
+}
\ No newline at end of file
@@ -5,14 +5,23 @@
 #include <string>
 #include <iostream>
 #include <algorithm>
+#include "Zobrist.h"
+#include "Move.h"
 
 namespace chessengine
 {
-	typedef int8_t rank;		// Board rank.
-	typedef int8_t file;		// Board file.
-	typedef int8_t piece_t;		// Piece type.
-	typedef int8_t color;		// Color (white/black). color XOR 6 to toggle between white and black. (color ^ Board::BLACK)
-	typedef uint8_t piece_p;	// Piece position.
+
+	// Undo record for a move made with Board::makeMove.
+	struct Undo
+	{
+		uint64_t key;		// Zobrist key before the move.
+		Move move;
+		int8_t piece;		// Moved piece (color + type).
+		int8_t captured;	// Captured piece (color + type), -1 if none.
+		uint8_t castling;	// Castling rights before the move.
+		piece_p enPassant;	// En passant square before the move.
+		uint16_t halfmoves;	// Halfmove clock before the move.
+	};
 
 	class Board
 	{
@@ -25,6 +34,10 @@ namespace chessengine
 		static const unsigned int NUM_OF_RANKS = 8;
 		static const unsigned int NUM_OF_FILES = 8;
 
+		// Maximum number of moves on the undo stack.
+
+		static const unsigned int MAX_HISTORY = 1024;
+
 		// Files
 
 		static const file A_FILE = 0;
@@ -69,7 +82,20 @@ namespace chessengine
 		static const piece_t BISHOP = 3;
 		static const piece_t QUEEN = 4;
 		static const piece_t KING = 5;
+		static const piece_t EMPTY = -1;
 
+		// Castling rights
+
+		static const uint8_t WHITE_KINGSIDE = 1;
+		static const uint8_t WHITE_QUEENSIDE = 2;
+		static const uint8_t BLACK_KINGSIDE = 4;
+		static const uint8_t BLACK_QUEENSIDE = 8;
+		static const uint8_t ALL_CASTLING = 15;
+
+		// En passant square when no en passant capture is possible.
+		static const piece_p NO_SQUARE = 64;
+
+		// Plain material values in centipawns, indexed by piece type.
 		static const unsigned int PIECE_VALUE[6];
 		static const std::string PIECE_NAME[6];
 
@@ -87,20 +113,124 @@ namespace chessengine
 
 
 		// Bitboards containing the position of all game pieces.
+		// Read only outside of Board, the occupancy masks and the mailbox are derived from them.
 		uint64_t bitboard[NUM_OF_BITBOARDS];
 
 		Board();
 		~Board();
 
 		void init();
-		uint64_t positionMask() const;
-		uint64_t colorPositionMask(const color &color) const;
-		color pieceColor(const uint64_t &posmask) const;
-		void movePiece(const piece_p pos, const piece_t type, const color color, const piece_p destination);
+
+		// Mask marking occupied squares on the board.
+		inline uint64_t positionMask() const
+		{
+			return occupancy;
+		}
+
+		// Mask marking squares occupied by a specific color.
+		inline uint64_t colorPositionMask(const color &color) const
+		{
+			return colorOccupancy[color / BLACK];
+		}
+
+		// Color of the piece at a given position, -1 if the square is empty.
+		inline color pieceColor(const uint64_t &posmask) const
+		{
+			if (colorOccupancy[0] & posmask) return WHITE;
+			if (colorOccupancy[1] & posmask) return BLACK;
+			return -1;
+		}
+
+		// Type of the piece at a given position, EMPTY if the square is empty.
+		inline piece_t pieceType(const piece_p pos) const
+		{
+			return mailbox[pos] == EMPTY ? EMPTY : mailbox[pos] % BLACK;
+		}
+
+		// Piece (color + type) at a given position, EMPTY if the square is empty.
+		inline int8_t pieceAt(const piece_p pos) const
+		{
+			return mailbox[pos];
+		}
+
+		inline uint8_t castlingRights() const
+		{
+			return castling;
+		}
+
+		// Plies since the last capture or pawn move.
+		inline unsigned int halfmoveClock() const
+		{
+			return halfmoves;
+		}
+
+		// True if the game is drawn by the fifty-move rule or by a repetition.
+		inline bool isDraw() const
+		{
+			return halfmoves >= 100 || isRepetition();
+		}
+
+		// Square a pawn can capture en passant on, NO_SQUARE if none.
+		inline piece_p enPassantSquare() const
+		{
+			return enPassant;
+		}
+
+		// Zobrist key of the pawns of both colors alone, used by the pawn structure cache.
+		inline uint64_t pawnHash() const
+		{
+			return pawnKey;
+		}
+
+		// White-relative middlegame score of the material and piece placement.
+		inline short midgameScore() const
+		{
+			return midgame;
+		}
+
+		// White-relative endgame score of the material and piece placement.
+		inline short endgameScore() const
+		{
+			return endgame;
+		}
+
+		// Game phase of the remaining material, PieceSquareTables::MAX_PHASE at the start. May exceed it after promotions.
+		inline uint8_t gamePhase() const
+		{
+			return phase;
+		}
+
+		// Number of undo records on the stack.
+		inline unsigned int historyLength() const
+		{
+			return historySize;
+		}
+
+		// Undo record of the last move made with makeMove.
+		inline const Undo &lastMove() const
+		{
+			return history[historySize - 1];
+		}
+
+		// Zobrist key of the position with the given color to move.
+		inline uint64_t hash(const color turn) const
+		{
+			return turn == BLACK ? key ^ Zobrist::KEYS.blackToMove : key;
+		}
+
+		void movePiece(const Move move, const color color);
 		void setSquare(const piece_p pos, const piece_t type, const color color);
 		void clearSquare(const piece_p pos);
+		void setCastlingRights(const uint8_t rights);
+		void setEnPassant(const piece_p pos);
+		void setHalfmoveClock(const unsigned int clock);
+		void makeMove(const Move move, const color color);
+		void unmakeMove();
+		void trimHistory();
+		bool isRepetition() const;
+		uint64_t attackers(const piece_p pos, const color attacker, const uint64_t occupancy) const;
+		bool isSquareAttacked(const piece_p pos, const color attacker) const;
 		bool isKingCheck(const color color) const;
-		piece_t pieceType(const piece_p pos) const;
 
 		static void print(const uint64_t &);
 		void printFull() const;
@@ -110,6 +240,40 @@ namespace chessengine
 
 	private:
 
+		// Squares occupied by each color (indexed by color / BLACK) and by any piece.
+		uint64_t colorOccupancy[2];
+		uint64_t occupancy;
+
+		// Piece (color + type) on every square, EMPTY if none.
+		int8_t mailbox[64];
+
+		// Castling rights and en passant square.
+		uint8_t castling;
+		piece_p enPassant;
+
+		// Plies since the last capture or pawn move.
+		uint16_t halfmoves;
+
+		// Zobrist key of the piece placement, castling rights and en passant square, updated incrementally.
+		uint64_t key;
+
+		// Zobrist key of the pawn placement, updated incrementally like key but not restored from the undo record.
+		uint64_t pawnKey;
+
+		// Evaluation terms, updated incrementally like the key.
+		short midgame;
+		short endgame;
+		uint8_t phase;
+
+		// Undo stack of moves made with makeMove. The keys of the records are the keys of the earlier positions of
+		// the game, which repetition detection compares with.
+		Undo history[MAX_HISTORY];
+		unsigned int historySize;
+
+		void addPiece(const piece_p pos, const int8_t piece);
+		void removePiece(const piece_p pos);
+		void refresh();
+
 	};
 
 }
\ No newline at end of file
@@ -0,0 +1,439 @@
+#include "Book.h"
+#include "MoveGenerator.h"
+#include "Bitops.h"
+#include "UCI.h"
+#include <cstdlib>
+#include <iomanip>
+
+using namespace chessengine;
+
+// Polyglot promotion codes by promoted piece type.
+static const uint16_t PROMOTION_CODE[6] = { 0, 3, 1, 2, 4, 0 };
+
+// Offset of the black piece of each type in the Polyglot piece numbering, the white piece follows it.
+static const unsigned int POLYGLOT_KIND[6] = { 0, 6, 2, 4, 8, 10 };
+
+// Polyglot random numbers: 768 for the pieces (64 squares of each kind: black pawn, white pawn, black knight, ...,
+// white king), 4 for the castling rights (white short, white long, black short, black long), 8 for the en passant
+// file and 1 for white to move.
+static const uint64_t POLYGLOT_RANDOM[781] =
+{
+	0x9D39247E33776D41ui64, 0x2AF7398005AAA5C7ui64, 0x44DB015024623547ui64, 0x9C15F73E62A76AE2ui64,
+	0x75834465489C0C89ui64, 0x3290AC3A203001BFui64, 0x0FBBAD1F61042279ui64, 0xE83A908FF2FB60CAui64,
+	0x0D7E765D58755C10ui64, 0x1A083822CEAFE02Dui64, 0x9605D5F0E25EC3B0ui64, 0xD021FF5CD13A2ED5ui64,
+	0x40BDF15D4A672E32ui64, 0x011355146FD56395ui64, 0x5DB4832046F3D9E5ui64, 0x239F8B2D7FF719CCui64,
+	0x05D1A1AE85B49AA1ui64, 0x679F848F6E8FC971ui64, 0x7449BBFF801FED0Bui64, 0x7D11CDB1C3B7ADF0ui64,
+	0x82C7709E781EB7CCui64, 0xF3218F1C9510786Cui64, 0x331478F3AF51BBE6ui64, 0x4BB38DE5E7219443ui64,
+	0xAA649C6EBCFD50FCui64, 0x8DBD98A352AFD40Bui64, 0x87D2074B81D79217ui64, 0x19F3C751D3E92AE1ui64,
+	0xB4AB30F062B19ABFui64, 0x7B0500AC42047AC4ui64, 0xC9452CA81A09D85Dui64, 0x24AA6C514DA27500ui64,
+	0x4C9F34427501B447ui64, 0x14A68FD73C910841ui64, 0xA71B9B83461CBD93ui64, 0x03488B95B0F1850Fui64,
+	0x637B2B34FF93C040ui64, 0x09D1BC9A3DD90A94ui64, 0x3575668334A1DD3Bui64, 0x735E2B97A4C45A23ui64,
+	0x18727070F1BD400Bui64, 0x1FCBACD259BF02E7ui64, 0xD310A7C2CE9B6555ui64, 0xBF983FE0FE5D8244ui64,
+	0x9F74D14F7454A824ui64, 0x51EBDC4AB9BA3035ui64, 0x5C82C505DB9AB0FAui64, 0xFCF7FE8A3430B241ui64,
+	0x3253A729B9BA3DDEui64, 0x8C74C368081B3075ui64, 0xB9BC6C87167C33E7ui64, 0x7EF48F2B83024E20ui64,
+	0x11D505D4C351BD7Fui64, 0x6568FCA92C76A243ui64, 0x4DE0B0F40F32A7B8ui64, 0x96D693460CC37E5Dui64,
+	0x42E240CB63689F2Fui64, 0x6D2BDCDAE2919661ui64, 0x42880B0236E4D951ui64, 0x5F0F4A5898171BB6ui64,
+	0x39F890F579F92F88ui64, 0x93C5B5F47356388Bui64, 0x63DC359D8D231B78ui64, 0xEC16CA8AEA98AD76ui64,
+	0x5355F900C2A82DC7ui64, 0x07FB9F855A997142ui64, 0x5093417AA8A7ED5Eui64, 0x7BCBC38DA25A7F3Cui64,
+	0x19FC8A768CF4B6D4ui64, 0x637A7780DECFC0D9ui64, 0x8249A47AEE0E41F7ui64, 0x79AD695501E7D1E8ui64,
+	0x14ACBAF4777D5776ui64, 0xF145B6BECCDEA195ui64, 0xDABF2AC8201752FCui64, 0x24C3C94DF9C8D3F6ui64,
+	0xBB6E2924F03912EAui64, 0x0CE26C0B95C980D9ui64, 0xA49CD132BFBF7CC4ui64, 0xE99D662AF4243939ui64,
+	0x27E6AD7891165C3Fui64, 0x8535F040B9744FF1ui64, 0x54B3F4FA5F40D873ui64, 0x72B12C32127FED2Bui64,
+	0xEE954D3C7B411F47ui64, 0x9A85AC909A24EAA1ui64, 0x70AC4CD9F04F21F5ui64, 0xF9B89D3E99A075C2ui64,
+	0x87B3E2B2B5C907B1ui64, 0xA366E5B8C54F48B8ui64, 0xAE4A9346CC3F7CF2ui64, 0x1920C04D47267BBDui64,
+	0x87BF02C6B49E2AE9ui64, 0x092237AC237F3859ui64, 0xFF07F64EF8ED14D0ui64, 0x8DE8DCA9F03CC54Eui64,
+	0x9C1633264DB49C89ui64, 0xB3F22C3D0B0B38EDui64, 0x390E5FB44D01144Bui64, 0x5BFEA5B4712768E9ui64,
+	0x1E1032911FA78984ui64, 0x9A74ACB964E78CB3ui64, 0x4F80F7A035DAFB04ui64, 0x6304D09A0B3738C4ui64,
+	0x2171E64683023A08ui64, 0x5B9B63EB9CEFF80Cui64, 0x506AACF489889342ui64, 0x1881AFC9A3A701D6ui64,
+	0x6503080440750644ui64, 0xDFD395339CDBF4A7ui64, 0xEF927DBCF00C20F2ui64, 0x7B32F7D1E03680ECui64,
+	0xB9FD7620E7316243ui64, 0x05A7E8A57DB91B77ui64, 0xB5889C6E15630A75ui64, 0x4A750A09CE9573F7ui64,
+	0xCF464CEC899A2F8Aui64, 0xF538639CE705B824ui64, 0x3C79A0FF5580EF7Fui64, 0xEDE6C87F8477609Dui64,
+	0x799E81F05BC93F31ui64, 0x86536B8CF3428A8Cui64, 0x97D7374C60087B73ui64, 0xA246637CFF328532ui64,
+	0x043FCAE60CC0EBA0ui64, 0x920E449535DD359Eui64, 0x70EB093B15B290CCui64, 0x73A1921916591CBDui64,
+	0x56436C9FE1A1AA8Dui64, 0xEFAC4B70633B8F81ui64, 0xBB215798D45DF7AFui64, 0x45F20042F24F1768ui64,
+	0x930F80F4E8EB7462ui64, 0xFF6712FFCFD75EA1ui64, 0xAE623FD67468AA70ui64, 0xDD2C5BC84BC8D8FCui64,
+	0x7EED120D54CF2DD9ui64, 0x22FE545401165F1Cui64, 0xC91800E98FB99929ui64, 0x808BD68E6AC10365ui64,
+	0xDEC468145B7605F6ui64, 0x1BEDE3A3AEF53302ui64, 0x43539603D6C55602ui64, 0xAA969B5C691CCB7Aui64,
+	0xA87832D392EFEE56ui64, 0x65942C7B3C7E11AEui64, 0xDED2D633CAD004F6ui64, 0x21F08570F420E565ui64,
+	0xB415938D7DA94E3Cui64, 0x91B859E59ECB6350ui64, 0x10CFF333E0ED804Aui64, 0x28AED140BE0BB7DDui64,
+	0xC5CC1D89724FA456ui64, 0x5648F680F11A2741ui64, 0x2D255069F0B7DAB3ui64, 0x9BC5A38EF729ABD4ui64,
+	0xEF2F054308F6A2BCui64, 0xAF2042F5CC5C2858ui64, 0x480412BAB7F5BE2Aui64, 0xAEF3AF4A563DFE43ui64,
+	0x19AFE59AE451497Fui64, 0x52593803DFF1E840ui64, 0xF4F076E65F2CE6F0ui64, 0x11379625747D5AF3ui64,
+	0xBCE5D2248682C115ui64, 0x9DA4243DE836994Fui64, 0x066F70B33FE09017ui64, 0x4DC4DE189B671A1Cui64,
+	0x51039AB7712457C3ui64, 0xC07A3F80C31FB4B4ui64, 0xB46EE9C5E64A6E7Cui64, 0xB3819A42ABE61C87ui64,
+	0x21A007933A522A20ui64, 0x2DF16F761598AA4Fui64, 0x763C4A1371B368FDui64, 0xF793C46702E086A0ui64,
+	0xD7288E012AEB8D31ui64, 0xDE336A2A4BC1C44Bui64, 0x0BF692B38D079F23ui64, 0x2C604A7A177326B3ui64,
+	0x4850E73E03EB6064ui64, 0xCFC447F1E53C8E1Bui64, 0xB05CA3F564268D99ui64, 0x9AE182C8BC9474E8ui64,
+	0xA4FC4BD4FC5558CAui64, 0xE755178D58FC4E76ui64, 0x69B97DB1A4C03DFEui64, 0xF9B5B7C4ACC67C96ui64,
+	0xFC6A82D64B8655FBui64, 0x9C684CB6C4D24417ui64, 0x8EC97D2917456ED0ui64, 0x6703DF9D2924E97Eui64,
+	0xC547F57E42A7444Eui64, 0x78E37644E7CAD29Eui64, 0xFE9A44E9362F05FAui64, 0x08BD35CC38336615ui64,
+	0x9315E5EB3A129ACEui64, 0x94061B871E04DF75ui64, 0xDF1D9F9D784BA010ui64, 0x3BBA57B68871B59Dui64,
+	0xD2B7ADEEDED1F73Fui64, 0xF7A255D83BC373F8ui64, 0xD7F4F2448C0CEB81ui64, 0xD95BE88CD210FFA7ui64,
+	0x336F52F8FF4728E7ui64, 0xA74049DAC312AC71ui64, 0xA2F61BB6E437FDB5ui64, 0x4F2A5CB07F6A35B3ui64,
+	0x87D380BDA5BF7859ui64, 0x16B9F7E06C453A21ui64, 0x7BA2484C8A0FD54Eui64, 0xF3A678CAD9A2E38Cui64,
+	0x39B0BF7DDE437BA2ui64, 0xFCAF55C1BF8A4424ui64, 0x18FCF680573FA594ui64, 0x4C0563B89F495AC3ui64,
+	0x40E087931A00930Dui64, 0x8CFFA9412EB642C1ui64, 0x68CA39053261169Fui64, 0x7A1EE967D27579E2ui64,
+	0x9D1D60E5076F5B6Fui64, 0x3810E399B6F65BA2ui64, 0x32095B6D4AB5F9B1ui64, 0x35CAB62109DD038Aui64,
+	0xA90B24499FCFAFB1ui64, 0x77A225A07CC2C6BDui64, 0x513E5E634C70E331ui64, 0x4361C0CA3F692F12ui64,
+	0xD941ACA44B20A45Bui64, 0x528F7C8602C5807Bui64, 0x52AB92BEB9613989ui64, 0x9D1DFA2EFC557F73ui64,
+	0x722FF175F572C348ui64, 0x1D1260A51107FE97ui64, 0x7A249A57EC0C9BA2ui64, 0x04208FE9E8F7F2D6ui64,
+	0x5A110C6058B920A0ui64, 0x0CD9A497658A5698ui64, 0x56FD23C8F9715A4Cui64, 0x284C847B9D887AAEui64,
+	0x04FEABFBBDB619CBui64, 0x742E1E651C60BA83ui64, 0x9A9632E65904AD3Cui64, 0x881B82A13B51B9E2ui64,
+	0x506E6744CD974924ui64, 0xB0183DB56FFC6A79ui64, 0x0ED9B915C66ED37Eui64, 0x5E11E86D5873D484ui64,
+	0xF678647E3519AC6Eui64, 0x1B85D488D0F20CC5ui64, 0xDAB9FE6525D89021ui64, 0x0D151D86ADB73615ui64,
+	0xA865A54EDCC0F019ui64, 0x93C42566AEF98FFBui64, 0x99E7AFEABE000731ui64, 0x48CBFF086DDF285Aui64,
+	0x7F9B6AF1EBF78BAFui64, 0x58627E1A149BBA21ui64, 0x2CD16E2ABD791E33ui64, 0xD363EFF5F0977996ui64,
+	0x0CE2A38C344A6EEDui64, 0x1A804AADB9CFA741ui64, 0x907F30421D78C5DEui64, 0x501F65EDB3034D07ui64,
+	0x37624AE5A48FA6E9ui64, 0x957BAF61700CFF4Eui64, 0x3A6C27934E31188Aui64, 0xD49503536ABCA345ui64,
+	0x088E049589C432E0ui64, 0xF943AEE7FEBF21B8ui64, 0x6C3B8E3E336139D3ui64, 0x364F6FFA464EE52Eui64,
+	0xD60F6DCEDC314222ui64, 0x56963B0DCA418FC0ui64, 0x16F50EDF91E513AFui64, 0xEF1955914B609F93ui64,
+	0x565601C0364E3228ui64, 0xECB53939887E8175ui64, 0xBAC7A9A18531294Bui64, 0xB344C470397BBA52ui64,
+	0x65D34954DAF3CEBDui64, 0xB4B81B3FA97511E2ui64, 0xB422061193D6F6A7ui64, 0x071582401C38434Dui64,
+	0x7A13F18BBEDC4FF5ui64, 0xBC4097B116C524D2ui64, 0x59B97885E2F2EA28ui64, 0x99170A5DC3115544ui64,
+	0x6F423357E7C6A9F9ui64, 0x325928EE6E6F8794ui64, 0xD0E4366228B03343ui64, 0x565C31F7DE89EA27ui64,
+	0x30F5611484119414ui64, 0xD873DB391292ED4Fui64, 0x7BD94E1D8E17DEBCui64, 0xC7D9F16864A76E94ui64,
+	0x947AE053EE56E63Cui64, 0xC8C93882F9475F5Fui64, 0x3A9BF55BA91F81CAui64, 0xD9A11FBB3D9808E4ui64,
+	0x0FD22063EDC29FCAui64, 0xB3F256D8ACA0B0B9ui64, 0xB03031A8B4516E84ui64, 0x35DD37D5871448AFui64,
+	0xE9F6082B05542E4Eui64, 0xEBFAFA33D7254B59ui64, 0x9255ABB50D532280ui64, 0xB9AB4CE57F2D34F3ui64,
+	0x693501D628297551ui64, 0xC62C58F97DD949BFui64, 0xCD454F8F19C5126Aui64, 0xBBE83F4ECC2BDECBui64,
+	0xDC842B7E2819E230ui64, 0xBA89142E007503B8ui64, 0xA3BC941D0A5061CBui64, 0xE9F6760E32CD8021ui64,
+	0x09C7E552BC76492Fui64, 0x852F54934DA55CC9ui64, 0x8107FCCF064FCF56ui64, 0x098954D51FFF6580ui64,
+	0x23B70EDB1955C4BFui64, 0xC330DE426430F69Dui64, 0x4715ED43E8A45C0Aui64, 0xA8D7E4DAB780A08Dui64,
+	0x0572B974F03CE0BBui64, 0xB57D2E985E1419C7ui64, 0xE8D9ECBE2CF3D73Fui64, 0x2FE4B17170E59750ui64,
+	0x11317BA87905E790ui64, 0x7FBF21EC8A1F45ECui64, 0x1725CABFCB045B00ui64, 0x964E915CD5E2B207ui64,
+	0x3E2B8BCBF016D66Dui64, 0xBE7444E39328A0ACui64, 0xF85B2B4FBCDE44B7ui64, 0x49353FEA39BA63B1ui64,
+	0x1DD01AAFCD53486Aui64, 0x1FCA8A92FD719F85ui64, 0xFC7C95D827357AFAui64, 0x18A6A990C8B35EBDui64,
+	0xCCCB7005C6B9C28Dui64, 0x3BDBB92C43B17F26ui64, 0xAA70B5B4F89695A2ui64, 0xE94C39A54A98307Fui64,
+	0xB7A0B174CFF6F36Eui64, 0xD4DBA84729AF48ADui64, 0x2E18BC1AD9704A68ui64, 0x2DE0966DAF2F8B1Cui64,
+	0xB9C11D5B1E43A07Eui64, 0x64972D68DEE33360ui64, 0x94628D38D0C20584ui64, 0xDBC0D2B6AB90A559ui64,
+	0xD2733C4335C6A72Fui64, 0x7E75D99D94A70F4Dui64, 0x6CED1983376FA72Bui64, 0x97FCAACBF030BC24ui64,
+	0x7B77497B32503B12ui64, 0x8547EDDFB81CCB94ui64, 0x79999CDFF70902CBui64, 0xCFFE1939438E9B24ui64,
+	0x829626E3892D95D7ui64, 0x92FAE24291F2B3F1ui64, 0x63E22C147B9C3403ui64, 0xC678B6D860284A1Cui64,
+	0x5873888850659AE7ui64, 0x0981DCD296A8736Dui64, 0x9F65789A6509A440ui64, 0x9FF38FED72E9052Fui64,
+	0xE479EE5B9930578Cui64, 0xE7F28ECD2D49EECDui64, 0x56C074A581EA17FEui64, 0x5544F7D774B14AEFui64,
+	0x7B3F0195FC6F290Fui64, 0x12153635B2C0CF57ui64, 0x7F5126DBBA5E0CA7ui64, 0x7A76956C3EAFB413ui64,
+	0x3D5774A11D31AB39ui64, 0x8A1B083821F40CB4ui64, 0x7B4A38E32537DF62ui64, 0x950113646D1D6E03ui64,
+	0x4DA8979A0041E8A9ui64, 0x3BC36E078F7515D7ui64, 0x5D0A12F27AD310D1ui64, 0x7F9D1A2E1EBE1327ui64,
+	0xDA3A361B1C5157B1ui64, 0xDCDD7D20903D0C25ui64, 0x36833336D068F707ui64, 0xCE68341F79893389ui64,
+	0xAB9090168DD05F34ui64, 0x43954B3252DC25E5ui64, 0xB438C2B67F98E5E9ui64, 0x10DCD78E3851A492ui64,
+	0xDBC27AB5447822BFui64, 0x9B3CDB65F82CA382ui64, 0xB67B7896167B4C84ui64, 0xBFCED1B0048EAC50ui64,
+	0xA9119B60369FFEBDui64, 0x1FFF7AC80904BF45ui64, 0xAC12FB171817EEE7ui64, 0xAF08DA9177DDA93Dui64,
+	0x1B0CAB936E65C744ui64, 0xB559EB1D04E5E932ui64, 0xC37B45B3F8D6F2BAui64, 0xC3A9DC228CAAC9E9ui64,
+	0xF3B8B6675A6507FFui64, 0x9FC477DE4ED681DAui64, 0x67378D8ECCEF96CBui64, 0x6DD856D94D259236ui64,
+	0xA319CE15B0B4DB31ui64, 0x073973751F12DD5Eui64, 0x8A8E849EB32781A5ui64, 0xE1925C71285279F5ui64,
+	0x74C04BF1790C0EFEui64, 0x4DDA48153C94938Aui64, 0x9D266D6A1CC0542Cui64, 0x7440FB816508C4FEui64,
+	0x13328503DF48229Fui64, 0xD6BF7BAEE43CAC40ui64, 0x4838D65F6EF6748Fui64, 0x1E152328F3318DEAui64,
+	0x8F8419A348F296BFui64, 0x72C8834A5957B511ui64, 0xD7A023A73260B45Cui64, 0x94EBC8ABCFB56DAEui64,
+	0x9FC10D0F989993E0ui64, 0xDE68A2355B93CAE6ui64, 0xA44CFE79AE538BBEui64, 0x9D1D84FCCE371425ui64,
+	0x51D2B1AB2DDFB636ui64, 0x2FD7E4B9E72CD38Cui64, 0x65CA5B96B7552210ui64, 0xDD69A0D8AB3B546Dui64,
+	0x604D51B25FBF70E2ui64, 0x73AA8A564FB7AC9Eui64, 0x1A8C1E992B941148ui64, 0xAAC40A2703D9BEA0ui64,
+	0x764DBEAE7FA4F3A6ui64, 0x1E99B96E70A9BE8Bui64, 0x2C5E9DEB57EF4743ui64, 0x3A938FEE32D29981ui64,
+	0x26E6DB8FFDF5ADFEui64, 0x469356C504EC9F9Dui64, 0xC8763C5B08D1908Cui64, 0x3F6C6AF859D80055ui64,
+	0x7F7CC39420A3A545ui64, 0x9BFB227EBDF4C5CEui64, 0x89039D79D6FC5C5Cui64, 0x8FE88B57305E2AB6ui64,
+	0xA09E8C8C35AB96DEui64, 0xFA7E393983325753ui64, 0xD6B6D0ECC617C699ui64, 0xDFEA21EA9E7557E3ui64,
+	0xB67C1FA481680AF8ui64, 0xCA1E3785A9E724E5ui64, 0x1CFC8BED0D681639ui64, 0xD18D8549D140CAEAui64,
+	0x4ED0FE7E9DC91335ui64, 0xE4DBF0634473F5D2ui64, 0x1761F93A44D5AEFEui64, 0x53898E4C3910DA55ui64,
+	0x734DE8181F6EC39Aui64, 0x2680B122BAA28D97ui64, 0x298AF231C85BAFABui64, 0x7983EED3740847D5ui64,
+	0x66C1A2A1A60CD889ui64, 0x9E17E49642A3E4C1ui64, 0xEDB454E7BADC0805ui64, 0x50B704CAB602C329ui64,
+	0x4CC317FB9CDDD023ui64, 0x66B4835D9EAFEA22ui64, 0x219B97E26FFC81BDui64, 0x261E4E4C0A333A9Dui64,
+	0x1FE2CCA76517DB90ui64, 0xD7504DFA8816EDBBui64, 0xB9571FA04DC089C8ui64, 0x1DDC0325259B27DEui64,
+	0xCF3F4688801EB9AAui64, 0xF4F5D05C10CAB243ui64, 0x38B6525C21A42B0Eui64, 0x36F60E2BA4FA6800ui64,
+	0xEB3593803173E0CEui64, 0x9C4CD6257C5A3603ui64, 0xAF0C317D32ADAA8Aui64, 0x258E5A80C7204C4Bui64,
+	0x8B889D624D44885Dui64, 0xF4D14597E660F855ui64, 0xD4347F66EC8941C3ui64, 0xE699ED85B0DFB40Dui64,
+	0x2472F6207C2D0484ui64, 0xC2A1E7B5B459AEB5ui64, 0xAB4F6451CC1D45ECui64, 0x63767572AE3D6174ui64,
+	0xA59E0BD101731A28ui64, 0x116D0016CB948F09ui64, 0x2CF9C8CA052F6E9Fui64, 0x0B090A7560A968E3ui64,
+	0xABEEDDB2DDE06FF1ui64, 0x58EFC10B06A2068Dui64, 0xC6E57A78FBD986E0ui64, 0x2EAB8CA63CE802D7ui64,
+	0x14A195640116F336ui64, 0x7C0828DD624EC390ui64, 0xD74BBE77E6116AC7ui64, 0x804456AF10F5FB53ui64,
+	0xEBE9EA2ADF4321C7ui64, 0x03219A39EE587A30ui64, 0x49787FEF17AF9924ui64, 0xA1E9300CD8520548ui64,
+	0x5B45E522E4B1B4EFui64, 0xB49C3B3995091A36ui64, 0xD4490AD526F14431ui64, 0x12A8F216AF9418C2ui64,
+	0x001F837CC7350524ui64, 0x1877B51E57A764D5ui64, 0xA2853B80F17F58EEui64, 0x993E1DE72D36D310ui64,
+	0xB3598080CE64A656ui64, 0x252F59CF0D9F04BBui64, 0xD23C8E176D113600ui64, 0x1BDA0492E7E4586Eui64,
+	0x21E0BD5026C619BFui64, 0x3B097ADAF088F94Eui64, 0x8D14DEDB30BE846Eui64, 0xF95CFFA23AF5F6F4ui64,
+	0x3871700761B3F743ui64, 0xCA672B91E9E4FA16ui64, 0x64C8E531BFF53B55ui64, 0x241260ED4AD1E87Dui64,
+	0x106C09B972D2E822ui64, 0x7FBA195410E5CA30ui64, 0x7884D9BC6CB569D8ui64, 0x0647DFEDCD894A29ui64,
+	0x63573FF03E224774ui64, 0x4FC8E9560F91B123ui64, 0x1DB956E450275779ui64, 0xB8D91274B9E9D4FBui64,
+	0xA2EBEE47E2FBFCE1ui64, 0xD9F1F30CCD97FB09ui64, 0xEFED53D75FD64E6Bui64, 0x2E6D02C36017F67Fui64,
+	0xA9AA4D20DB084E9Bui64, 0xB64BE8D8B25396C1ui64, 0x70CB6AF7C2D5BCF0ui64, 0x98F076A4F7A2322Eui64,
+	0xBF84470805E69B5Fui64, 0x94C3251F06F90CF3ui64, 0x3E003E616A6591E9ui64, 0xB925A6CD0421AFF3ui64,
+	0x61BDD1307C66E300ui64, 0xBF8D5108E27E0D48ui64, 0x240AB57A8B888B20ui64, 0xFC87614BAF287E07ui64,
+	0xEF02CDD06FFDB432ui64, 0xA1082C0466DF6C0Aui64, 0x8215E577001332C8ui64, 0xD39BB9C3A48DB6CFui64,
+	0x2738259634305C14ui64, 0x61CF4F94C97DF93Dui64, 0x1B6BACA2AE4E125Bui64, 0x758F450C88572E0Bui64,
+	0x959F587D507A8359ui64, 0xB063E962E045F54Dui64, 0x60E8ED72C0DFF5D1ui64, 0x7B64978555326F9Fui64,
+	0xFD080D236DA814BAui64, 0x8C90FD9B083F4558ui64, 0x106F72FE81E2C590ui64, 0x7976033A39F7D952ui64,
+	0xA4EC0132764CA04Bui64, 0x733EA705FAE4FA77ui64, 0xB4D8F77BC3E56167ui64, 0x9E21F4F903B33FD9ui64,
+	0x9D765E419FB69F6Dui64, 0xD30C088BA61EA5EFui64, 0x5D94337FBFAF7F5Bui64, 0x1A4E4822EB4D7A59ui64,
+	0x6FFE73E81B637FB3ui64, 0xDDF957BC36D8B9CAui64, 0x64D0E29EEA8838B3ui64, 0x08DD9BDFD96B9F63ui64,
+	0x087E79E5A57D1D13ui64, 0xE328E230E3E2B3FBui64, 0x1C2559E30F0946BEui64, 0x720BF5F26F4D2EAAui64,
+	0xB0774D261CC609DBui64, 0x443F64EC5A371195ui64, 0x4112CF68649A260Eui64, 0xD813F2FAB7F5C5CAui64,
+	0x660D3257380841EEui64, 0x59AC2C7873F910A3ui64, 0xE846963877671A17ui64, 0x93B633ABFA3469F8ui64,
+	0xC0C0F5A60EF4CDCFui64, 0xCAF21ECD4377B28Cui64, 0x57277707199B8175ui64, 0x506C11B9D90E8B1Dui64,
+	0xD83CC2687A19255Fui64, 0x4A29C6465A314CD1ui64, 0xED2DF21216235097ui64, 0xB5635C95FF7296E2ui64,
+	0x22AF003AB672E811ui64, 0x52E762596BF68235ui64, 0x9AEBA33AC6ECC6B0ui64, 0x944F6DE09134DFB6ui64,
+	0x6C47BEC883A7DE39ui64, 0x6AD047C430A12104ui64, 0xA5B1CFDBA0AB4067ui64, 0x7C45D833AFF07862ui64,
+	0x5092EF950A16DA0Bui64, 0x9338E69C052B8E7Bui64, 0x455A4B4CFE30E3F5ui64, 0x6B02E63195AD0CF8ui64,
+	0x6B17B224BAD6BF27ui64, 0xD1E0CCD25BB9C169ui64, 0xDE0C89A556B9AE70ui64, 0x50065E535A213CF6ui64,
+	0x9C1169FA2777B874ui64, 0x78EDEFD694AF1EEDui64, 0x6DC93D9526A50E68ui64, 0xEE97F453F06791EDui64,
+	0x32AB0EDB696703D3ui64, 0x3A6853C7E70757A7ui64, 0x31865CED6120F37Dui64, 0x67FEF95D92607890ui64,
+	0x1F2B1D1F15F6DC9Cui64, 0xB69E38A8965C6B65ui64, 0xAA9119FF184CCCF4ui64, 0xF43C732873F24C13ui64,
+	0xFB4A3D794A9A80D2ui64, 0x3550C2321FD6109Cui64, 0x371F77E76BB8417Eui64, 0x6BFA9AAE5EC05779ui64,
+	0xCD04F3FF001A4778ui64, 0xE3273522064480CAui64, 0x9F91508BFFCFC14Aui64, 0x049A7F41061A9E60ui64,
+	0xFCB6BE43A9F2FE9Bui64, 0x08DE8A1C7797DA9Bui64, 0x8F9887E6078735A1ui64, 0xB5B4071DBFC73A66ui64,
+	0x230E343DFBA08D33ui64, 0x43ED7F5A0FAE657Dui64, 0x3A88A0FBBCB05C63ui64, 0x21874B8B4D2DBC4Fui64,
+	0x1BDEA12E35F6A8C9ui64, 0x53C065C6C8E63528ui64, 0xE34A1D250E7A8D6Bui64, 0xD6B04D3B7651DD7Eui64,
+	0x5E90277E7CB39E2Dui64, 0x2C046F22062DC67Dui64, 0xB10BB459132D0A26ui64, 0x3FA9DDFB67E2F199ui64,
+	0x0E09B88E1914F7AFui64, 0x10E8B35AF3EEAB37ui64, 0x9EEDECA8E272B933ui64, 0xD4C718BC4AE8AE5Fui64,
+	0x81536D601170FC20ui64, 0x91B534F885818A06ui64, 0xEC8177F83F900978ui64, 0x190E714FADA5156Eui64,
+	0xB592BF39B0364963ui64, 0x89C350C893AE7DC1ui64, 0xAC042E70F8B383F2ui64, 0xB49B52E587A1EE60ui64,
+	0xFB152FE3FF26DA89ui64, 0x3E666E6F69AE2C15ui64, 0x3B544EBE544C19F9ui64, 0xE805A1E290CF2456ui64,
+	0x24B33C9D7ED25117ui64, 0xE74733427B72F0C1ui64, 0x0A804D18B7097475ui64, 0x57E3306D881EDB4Fui64,
+	0x4AE7D6A36EB5DBCBui64, 0x2D8D5432157064C8ui64, 0xD1E649DE1E7F268Bui64, 0x8A328A1CEDFE552Cui64,
+	0x07A3AEC79624C7DAui64, 0x84547DDC3E203C94ui64, 0x990A98FD5071D263ui64, 0x1A4FF12616EEFC89ui64,
+	0xF6F7FD1431714200ui64, 0x30C05B1BA332F41Cui64, 0x8D2636B81555A786ui64, 0x46C9FEB55D120902ui64,
+	0xCCEC0A73B49C9921ui64, 0x4E9D2827355FC492ui64, 0x19EBB029435DCB0Fui64, 0x4659D2B743848A2Cui64,
+	0x963EF2C96B33BE31ui64, 0x74F85198B05A2E7Dui64, 0x5A0F544DD2B1FB18ui64, 0x03727073C2E134B1ui64,
+	0xC7F6AA2DE59AEA61ui64, 0x352787BAA0D7C22Fui64, 0x9853EAB63B5E0B35ui64, 0xABBDCDD7ED5C0860ui64,
+	0xCF05DAF5AC8D77B0ui64, 0x49CAD48CEBF4A71Eui64, 0x7A4C10EC2158C4A6ui64, 0xD9E92AA246BF719Eui64,
+	0x13AE978D09FE5557ui64, 0x730499AF921549FFui64, 0x4E4B705B92903BA4ui64, 0xFF577222C14F0A3Aui64,
+	0x55B6344CF97AAFAEui64, 0xB862225B055B6960ui64, 0xCAC09AFBDDD2CDB4ui64, 0xDAF8E9829FE96B5Fui64,
+	0xB5FDFC5D3132C498ui64, 0x310CB380DB6F7503ui64, 0xE87FBB46217A360Eui64, 0x2102AE466EBB1148ui64,
+	0xF8549E1A3AA5E00Dui64, 0x07A69AFDCC42261Aui64, 0xC4C118BFE78FEAAEui64, 0xF9F4892ED96BD438ui64,
+	0x1AF3DBE25D8F45DAui64, 0xF5B4B0B0D2DEEEB4ui64, 0x962ACEEFA82E1C84ui64, 0x046E3ECAAF453CE9ui64,
+	0xF05D129681949A4Cui64, 0x964781CE734B3C84ui64, 0x9C2ED44081CE5FBDui64, 0x522E23F3925E319Eui64,
+	0x177E00F9FC32F791ui64, 0x2BC60A63A6F3B3F2ui64, 0x222BBFAE61725606ui64, 0x486289DDCC3D6780ui64,
+	0x7DC7785B8EFDFC80ui64, 0x8AF38731C02BA980ui64, 0x1FAB64EA29A2DDF7ui64, 0xE4D9429322CD065Aui64,
+	0x9DA058C67844F20Cui64, 0x24C0E332B70019B0ui64, 0x233003B5A6CFE6ADui64, 0xD586BD01C5C217F6ui64,
+	0x5E5637885F29BC2Bui64, 0x7EBA726D8C94094Bui64, 0x0A56A5F0BFE39272ui64, 0xD79476A84EE20D06ui64,
+	0x9E4C1269BAA4BF37ui64, 0x17EFEE45B0DEE640ui64, 0x1D95B0A5FCF90BC6ui64, 0x93CBE0B699C2585Dui64,
+	0x65FA4F227A2B6D79ui64, 0xD5F9E858292504D5ui64, 0xC2B5A03F71471A6Fui64, 0x59300222B4561E00ui64,
+	0xCE2F8642CA0712DCui64, 0x7CA9723FBB2E8988ui64, 0x2785338347F2BA08ui64, 0xC61BB3A141E50E8Cui64,
+	0x150F361DAB9DEC26ui64, 0x9F6A419D382595F4ui64, 0x64A53DC924FE7AC9ui64, 0x142DE49FFF7A7C3Dui64,
+	0x0C335248857FA9E7ui64, 0x0A9C32D5EAE45305ui64, 0xE6C42178C4BBB92Eui64, 0x71F1CE2490D20B07ui64,
+	0xF1BCC3D275AFE51Aui64, 0xE728E8C83C334074ui64, 0x96FBF83A12884624ui64, 0x81A1549FD6573DA5ui64,
+	0x5FA7867CAF35E149ui64, 0x56986E2EF3ED091Bui64, 0x917F1DD5F8886C61ui64, 0xD20D8C88C8FFE65Fui64,
+	0x31D71DCE64B2C310ui64, 0xF165B587DF898190ui64, 0xA57E6339DD2CF3A0ui64, 0x1EF6E6DBB1961EC9ui64,
+	0x70CC73D90BC26E24ui64, 0xE21A6B35DF0C3AD7ui64, 0x003A93D8B2806962ui64, 0x1C99DED33CB890A1ui64,
+	0xCF3145DE0ADD4289ui64, 0xD0E4427A5514FB72ui64, 0x77C621CC9FB3A483ui64, 0x67A34DAC4356550Bui64,
+	0xF8D626AAAF278509ui64
+};
+
+// Positions of the Polyglot specification, with their keys.
+const Book::Position Book::SUITE[Book::SUITE_SIZE] =
+{
+	{ "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 0x463B96181691FC9Cui64 },
+	{ "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1", 0x823C9B50FD114196ui64 },
+	{ "rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 2", 0x0756B94461C50FB0ui64 },
+	{ "rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR b KQkq - 0 2", 0x662FAFB965DB29D4ui64 },
+	{ "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3", 0x22A48B5A8E47FF78ui64 },
+	{ "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR b kq - 0 3", 0x652A607CA3F242C1ui64 },
+	{ "rnbq1bnr/ppp1pkpp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR w - - 0 4", 0x00FDD303C946BDD9ui64 },
+	{ "rnbqkbnr/p1pppppp/8/8/PpP4P/8/1P1PPPP1/RNBQKBNR b KQkq c3 0 3", 0x3C8123EA7B067637ui64 },
+	{ "rnbqkbnr/p1pppppp/8/8/P6P/R1p5/1P1PPPP1/1NBQKBNR b Kkq - 0 4", 0x5C3F9B829B279560ui64 },
+};
+
+MappedFile Book::file;
+size_t Book::entryCount = 0;
+bool Book::enabled = true;
+
+// Maps the book at the given path, replacing the current one. Returns false and keeps the current book if the file
+// cannot be opened or is not a whole number of entries.
+bool Book::load(const std::string &path)
+{
+	MappedFile candidate;
+	if (!candidate.open(path) || candidate.size() % ENTRY_SIZE != 0)
+		return false;
+
+	file.swap(candidate);
+	entryCount = file.size() / ENTRY_SIZE;
+	return true;
+}
+
+
+void Book::unload()
+{
+	file.close();
+	entryCount = 0;
+}
+
+// Turns use of the book on or off without unloading it.
+void Book::setEnabled(const bool enabled)
+{
+	Book::enabled = enabled;
+}
+
+// True if moves are taken from the book.
+bool Book::active()
+{
+	return enabled && entryCount > 0;
+}
+
+// Picks a book move of the position, at random with probability proportional to the weights. Returns false if
+// the position is not in the book.
+bool Book::probe(Board &board, const color turn, Move &move)
+{
+	if (!active())
+		return false;
+
+	const uint64_t positionKey = key(board, turn);
+
+	// First entry of the position.
+	size_t low = 0;
+	size_t high = entryCount;
+	while (low < high)
+	{
+		const size_t middle = low + (high - low) / 2;
+		if (readEntry(middle).key < positionKey)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	uint32_t totalWeight = 0;
+	size_t end = low;
+	for (; end < entryCount; end++)
+	{
+		const Entry entry = readEntry(end);
+		if (entry.key != positionKey)
+			break;
+		totalWeight += entry.weight;
+	}
+
+	if (end == low)
+		return false;
+
+	// rand() may only give 15 bits, so two calls are combined.
+	uint32_t pick = totalWeight > 0 ? ((uint32_t)rand() << 15 ^ (uint32_t)rand()) % totalWeight : 0;
+
+	for (size_t i = low; i < end; i++)
+	{
+		const Entry entry = readEntry(i);
+		if (pick < entry.weight || i == end - 1)
+		{
+			// A move that is not legal in the position means a key collision or a broken book.
+			move = decodeMove(board, turn, entry.move);
+			return move != Move::none();
+		}
+		pick -= entry.weight;
+	}
+
+	return false;
+}
+
+// Polyglot key of a position: the pieces, the castling rights, the en passant file if a pawn of the side to move
+// can capture en passant, and the side to move. The board only keeps an en passant square such a pawn attacks.
+uint64_t Book::key(const Board &board, const color turn)
+{
+	uint64_t positionKey = 0;
+
+	for (int8_t piece = 0; piece < (int8_t)Board::NUM_OF_BITBOARDS; piece++)
+	{
+		const unsigned int kind = POLYGLOT_KIND[piece % Board::BLACK] + (piece < Board::BLACK ? 1 : 0);
+		uint64_t mask = board.bitboard[piece];
+		while (mask)
+			positionKey ^= POLYGLOT_RANDOM[64 * kind + popLSB(mask)];
+	}
+
+	const uint8_t castling = board.castlingRights();
+	if (castling & Board::WHITE_KINGSIDE) positionKey ^= POLYGLOT_RANDOM[768];
+	if (castling & Board::WHITE_QUEENSIDE) positionKey ^= POLYGLOT_RANDOM[769];
+	if (castling & Board::BLACK_KINGSIDE) positionKey ^= POLYGLOT_RANDOM[770];
+	if (castling & Board::BLACK_QUEENSIDE) positionKey ^= POLYGLOT_RANDOM[771];
+
+	if (board.enPassantSquare() != Board::NO_SQUARE)
+		positionKey ^= POLYGLOT_RANDOM[772 + board.enPassantSquare() % 8];
+
+	if (turn == Board::WHITE)
+		positionKey ^= POLYGLOT_RANDOM[780];
+
+	return positionKey;
+}
+
+// Book encoding of a move.
+uint16_t Book::encodeMove(const Move &move)
+{
+	piece_p dest = move.dest();
+
+	// The king moves two squares when castling, the book moves it onto its rook.
+	if (move.kind() == Move::CASTLING)
+		dest = dest > move.pos() ? dest + 1 : dest - 2;
+
+	uint16_t encoded = (uint16_t)(dest | move.pos() << 6);
+	if (move.kind() == Move::PROMOTION)
+		encoded |= PROMOTION_CODE[move.promotion()] << 12;
+	return encoded;
+}
+
+// Legal move of the position with the given book encoding, Move::none() if there is none.
+Move Book::decodeMove(Board &board, const color turn, const uint16_t move)
+{
+	MoveList moves;
+	MoveGenerator::generateMoves(board, turn, moves);
+
+	for (const Move &candidate : moves)
+	{
+		if (encodeMove(candidate) == move)
+			return candidate;
+	}
+
+	return Move::none();
+}
+
+// Writes an entry in the book layout.
+void Book::writeEntry(uint8_t *data, const Entry &entry)
+{
+	for (int i = 0; i < 8; i++)
+		data[i] = (uint8_t)(entry.key >> (56 - 8 * i));
+
+	data[8] = (uint8_t)(entry.move >> 8);
+	data[9] = (uint8_t)entry.move;
+	data[10] = (uint8_t)(entry.weight >> 8);
+	data[11] = (uint8_t)entry.weight;
+
+	for (int i = 0; i < 4; i++)
+		data[12 + i] = (uint8_t)(entry.learn >> (24 - 8 * i));
+}
+
+
+Book::Entry Book::readEntry(const size_t index)
+{
+	const uint8_t *data = file.data() + index * ENTRY_SIZE;
+	Entry entry;
+
+	entry.key = 0;
+	for (int i = 0; i < 8; i++)
+		entry.key = entry.key << 8 | data[i];
+
+	entry.move = (uint16_t)(data[8] << 8 | data[9]);
+	entry.weight = (uint16_t)(data[10] << 8 | data[11]);
+
+	entry.learn = 0;
+	for (int i = 12; i < 16; i++)
+		entry.learn = entry.learn << 8 | data[i];
+
+	return entry;
+}
+
+// Checks the keys of the positions of the Polyglot specification. Returns true if all keys match.
+bool Book::runSuite(std::ostream &out)
+{
+	bool passed = true;
+
+	for (unsigned int i = 0; i < SUITE_SIZE; i++)
+	{
+		const Position &position = SUITE[i];
+		color turn;
+		const Board board = UCI::createBoardFromFen(position.fen, turn);
+		const uint64_t positionKey = key(board, turn);
+		const bool match = positionKey == position.key;
+
+		out << "Position " << i + 1 << ": " << position.fen << std::endl;
+		out << std::hex << std::setfill('0') << "  key " << std::setw(16) << positionKey << (match ? " ok" : " FAILED, expected ");
+		if (!match)
+			out << std::setw(16) << position.key;
+		out << std::dec << std::setfill(' ') << std::endl;
+
+		passed &= match;
+	}
+
+	out << std::endl << (passed ? "All keys match" : "Some keys do not match") << std::endl;
+	return passed;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <ostream>
+#include "Board.h"
+#include "MappedFile.h"
+
+namespace chessengine
+{
+
+	// Opening book in the Polyglot .bin layout: 16 byte entries sorted by position key, big endian,
+	//   key (uint64), move (uint16), weight (uint16), learn (uint32)
+	// Several entries with the same key are the book moves of one position, chosen with a probability proportional
+	// to their weight. The book is memory mapped and searched in place.
+	// Positions are keyed by the Polyglot hash, so books of other Polyglot tools can be read and books of the book
+	// builder can be used by them.
+	//
+	// Moves are encoded as in Polyglot: destination file (bits 0-2) and rank (bits 3-5), origin file (bits 6-8) and
+	// rank (bits 9-11), and the promotion piece (bits 12-14: none, knight, bishop, rook, queen). Castling is encoded
+	// as the king capturing its own rook.
+	class Book
+	{
+
+	public:
+
+		static const size_t ENTRY_SIZE = 16;
+
+		struct Entry
+		{
+			uint64_t key;
+			uint16_t move;
+			uint16_t weight;
+			uint32_t learn;
+		};
+
+		static bool load(const std::string &path);
+		static void unload();
+		static void setEnabled(const bool enabled);
+		static bool active();
+
+		static bool probe(Board &board, const color turn, Move &move);
+
+		static uint64_t key(const Board &board, const color turn);
+		static uint16_t encodeMove(const Move &move);
+		static Move decodeMove(Board &board, const color turn, const uint16_t move);
+		static void writeEntry(uint8_t *data, const Entry &entry);
+
+		static bool runSuite(std::ostream &out);
+
+	private:
+
+		static MappedFile file;
+		static size_t entryCount;
+		static bool enabled;
+
+		static Entry readEntry(const size_t index);
+
+		// A test position and its Polyglot key.
+		struct Position
+		{
+			const char *fen;
+			uint64_t key;
+		};
+
+		static const unsigned int SUITE_SIZE = 9;
+		static const Position SUITE[SUITE_SIZE];
+
+	};
+
+}
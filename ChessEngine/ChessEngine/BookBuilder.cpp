@@ -0,0 +1,486 @@
+#include "BookBuilder.h"
+#include "MoveGenerator.h"
+#include "MappedFile.h"
+#include "UCI.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <thread>
+
+using namespace chessengine;
+
+// Games reaching the positions of the Polyglot specification.
+const BookBuilder::Game BookBuilder::SUITE[BookBuilder::SUITE_SIZE] =
+{
+	{ "[Event \"?\"]\n\n1. e4 d5 2. e5 f5 3. Ke2 Kf7 4. Ke1 Ke8 1/2-1/2\n",
+		{ 0x463B96181691FC9Cui64, 0x823C9B50FD114196ui64, 0x0756B94461C50FB0ui64, 0x662FAFB965DB29D4ui64,
+		0x22A48B5A8E47FF78ui64, 0x652A607CA3F242C1ui64, 0x00FDD303C946BDD9ui64, 0 } },
+	{ "[Event \"?\"]\n\n1. a4 b5 2. h4 b4 3. c4 bxc3 4. Ra3 Nf6 1/2-1/2\n",
+		{ 0x463B96181691FC9Cui64, 0, 0, 0, 0, 0x3C8123EA7B067637ui64, 0, 0x5C3F9B829B279560ui64 } },
+};
+
+BookBuilder::BookBuilder(const unsigned int threads, const unsigned int maxPly)
+	: threads(threads > 0 ? threads : 1), maxPly(maxPly < Board::MAX_HISTORY ? maxPly : Board::MAX_HISTORY), games(0), skipped(0)
+{
+}
+
+// Adds the games of a PGN file. Returns false if the file cannot be read.
+bool BookBuilder::addFile(const std::string &path)
+{
+	MappedFile file;
+	if (!file.open(path))
+		return false;
+
+	const char *data = reinterpret_cast<const char *>(file.data());
+	const size_t size = file.size();
+
+	// Chunks start at an Event tag, the first tag of a game, so that no game is split. Several chunks per thread
+	// even out the work between the threads.
+	static const char GAME_START[] = "\n[Event ";
+	const size_t chunkCount = (size_t)threads * 16;
+	std::vector<const char *> bounds;
+	bounds.push_back(data);
+
+	for (size_t i = 1; i < chunkCount; i++)
+	{
+		const char *nominal = std::max(bounds.back(), data + size / chunkCount * i);
+		const char *start = std::search(nominal, data + size, GAME_START, GAME_START + sizeof(GAME_START) - 1);
+		if (start == data + size)
+			break;
+		if (start + 1 > bounds.back())
+			bounds.push_back(start + 1);
+	}
+	bounds.push_back(data + size);
+
+	std::atomic<size_t> nextChunk(0);
+	std::vector<std::thread> workers;
+
+	for (unsigned int t = 0; t < threads; t++)
+	{
+		workers.emplace_back([this, &bounds, &nextChunk]()
+		{
+			std::vector<Record> batches[SHARDS];
+
+			for (size_t chunk = nextChunk++; chunk + 1 < bounds.size(); chunk = nextChunk++)
+			{
+				parseChunk(bounds[chunk], bounds[chunk + 1], batches);
+			}
+
+			for (unsigned int shard = 0; shard < SHARDS; shard++)
+			{
+				flush(shard, batches[shard]);
+			}
+		});
+	}
+
+	for (std::thread &worker : workers)
+	{
+		worker.join();
+	}
+
+	return true;
+}
+
+// Writes the book, sorted by key and within a position by weight. Moves played in fewer than minGames games, or
+// that never scored, are left out. Weights are scaled down to 16 bits if needed. Returns false if the file cannot
+// be written.
+bool BookBuilder::write(const std::string &path, const unsigned int minGames) const
+{
+	std::vector<Book::Entry> entries;
+	uint32_t maxPoints = 0;
+
+	for (const Shard &shard : shards)
+	{
+		for (const auto &position : shard.positions)
+		{
+			for (const MoveStats &stats : position.second)
+			{
+				if (stats.games < minGames || stats.points == 0)
+					continue;
+
+				Book::Entry entry;
+				entry.key = position.first;
+				entry.move = stats.move;
+				entry.weight = 0;
+				entry.learn = stats.points;	// Weight before scaling, until the scale is known.
+				entries.push_back(entry);
+				maxPoints = std::max(maxPoints, stats.points);
+			}
+		}
+	}
+
+	const double scale = maxPoints > 0xFFFF ? (double)0xFFFF / maxPoints : 1.0;
+	for (Book::Entry &entry : entries)
+	{
+		entry.weight = (uint16_t)std::max(1.0, entry.learn * scale);
+		entry.learn = 0;
+	}
+
+	std::sort(entries.begin(), entries.end(), [](const Book::Entry &a, const Book::Entry &b)
+	{
+		return a.key != b.key ? a.key < b.key : a.weight > b.weight;
+	});
+
+	std::vector<uint8_t> buffer(entries.size() * Book::ENTRY_SIZE);
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		Book::writeEntry(buffer.data() + i * Book::ENTRY_SIZE, entries[i]);
+	}
+
+	std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+	stream.write(reinterpret_cast<const char *>(buffer.data()), (std::streamsize)buffer.size());
+	return (bool)stream;
+}
+
+// Games whose moves were added.
+uint64_t BookBuilder::gameCount() const
+{
+	return games;
+}
+
+// Games left out for an unknown result, a start position that cannot be read, or a move that cannot be played.
+uint64_t BookBuilder::skippedCount() const
+{
+	return skipped;
+}
+
+// Legal move of the position given in standard algebraic notation, like e4, exd5, Nbd7, R1e2, e8=Q or O-O.
+// Check and annotation marks are ignored. Returns Move::none() if no legal move or more than one matches.
+Move BookBuilder::parseSan(Board &board, const color turn, const std::string &san)
+{
+	MoveList moves;
+	MoveGenerator::generateMoves(board, turn, moves);
+
+	std::string text = san;
+	while (!text.empty() && strchr("+#!?", text.back()))
+		text.pop_back();
+
+	// Castling, with letter O or digit 0.
+	if (text == "O-O" || text == "0-0" || text == "O-O-O" || text == "0-0-0")
+	{
+		const bool queenside = text.size() == 5;
+		for (const Move &move : moves)
+		{
+			if (move.kind() == Move::CASTLING && (move.dest() < move.pos()) == queenside)
+				return move;
+		}
+		return Move::none();
+	}
+
+	piece_t type = Board::PAWN;
+	size_t i = 0;
+	if (!text.empty() && strchr("NBRQK", text[0]))
+	{
+		const char *letter = strchr("PRNBQK", text[0]);
+		type = (piece_t)(letter - "PRNBQK");
+		i = 1;
+	}
+
+	// Promotion, with or without '='.
+	piece_t promotion = Board::EMPTY;
+	if (text.size() > i + 2 && strchr("QRBNqrbn", text.back()))
+	{
+		promotion = (piece_t)(strchr("PRNBQK", toupper(text.back())) - "PRNBQK");
+		text.pop_back();
+		if (text.back() == '=')
+			text.pop_back();
+	}
+
+	// What is left are the squares: the destination and any origin file and rank.
+	std::string squares;
+	for (; i < text.size(); i++)
+	{
+		if (text[i] != 'x' && text[i] != '-' && text[i] != ':')
+			squares += text[i];
+	}
+
+	if (squares.size() < 2 || squares.size() > 4)
+		return Move::none();
+
+	const char destFile = squares[squares.size() - 2];
+	const char destRank = squares[squares.size() - 1];
+	if (destFile < 'a' || destFile > 'h' || destRank < '1' || destRank > '8')
+		return Move::none();
+
+	const piece_p dest = (piece_p)((destRank - '1') * 8 + (destFile - 'a'));
+	int originFile = -1;
+	int originRank = -1;
+
+	for (size_t j = 0; j + 2 < squares.size(); j++)
+	{
+		if (squares[j] >= 'a' && squares[j] <= 'h')
+			originFile = squares[j] - 'a';
+		else if (squares[j] >= '1' && squares[j] <= '8')
+			originRank = squares[j] - '1';
+		else
+			return Move::none();
+	}
+
+	Move found = Move::none();
+	for (const Move &move : moves)
+	{
+		if (move.dest() != dest || move.kind() == Move::CASTLING || board.pieceType(move.pos()) != type)
+			continue;
+		if ((originFile >= 0 && move.pos() % 8 != originFile) || (originRank >= 0 && move.pos() / 8 != originRank))
+			continue;
+		if ((move.kind() == Move::PROMOTION) != (promotion != Board::EMPTY)
+			|| (move.kind() == Move::PROMOTION && move.promotion() != promotion))
+			continue;
+
+		if (found != Move::none())
+			return Move::none();
+		found = move;
+	}
+
+	return found;
+}
+
+// Replays the games between begin and end and adds their moves to the batches.
+void BookBuilder::parseChunk(const char *begin, const char *end, std::vector<Record> (&batches)[SHARDS])
+{
+	std::vector<Record> moves;
+	const char *p = begin;
+
+	while (p < end)
+	{
+		while (p < end && isspace((unsigned char)*p))
+			p++;
+		if (p >= end)
+			break;
+
+		moves.clear();
+		const int result = replayGame(p, end, moves);
+
+		if (result == NO_RESULT)
+		{
+			skipped++;
+			continue;
+		}
+
+		games++;
+		for (Record &record : moves)
+		{
+			// The points are stored for white until the result is known.
+			record.points = record.points == 0 ? (uint8_t)result : (uint8_t)(WHITE_WINS - result);
+			addRecord(record, batches);
+		}
+	}
+}
+
+// Reads the game starting at p, leaves p after it and returns its result. The first maxPly moves are recorded,
+// with points 0 for white moves and 1 for black moves. Returns NO_RESULT if the game cannot be used.
+int BookBuilder::replayGame(const char *&p, const char *end, std::vector<Record> &moves)
+{
+	static const Board START = []() { Board board; board.init(); return board; }();
+
+	std::string fen;
+	int result = NO_RESULT;
+	bool valid = true;
+
+	// Tags, one per line.
+	while (p < end)
+	{
+		while (p < end && isspace((unsigned char)*p))
+			p++;
+		if (p >= end || *p != '[')
+			break;
+
+		const char *lineEnd = std::find(p, end, '\n');
+		if (lineEnd - p > 5 && strncmp(p, "[FEN ", 5) == 0)
+		{
+			const char *open = std::find(p, lineEnd, '"');
+			const char *close = open < lineEnd ? std::find(open + 1, lineEnd, '"') : lineEnd;
+			fen.assign(open < lineEnd ? open + 1 : lineEnd, close);
+		}
+		p = lineEnd;
+	}
+
+	color turn = Board::WHITE;
+	Board board = fen.empty() ? START : UCI::createBoardFromFen(fen, turn);
+	unsigned int ply = 0;
+
+	// Movetext up to the result, or up to the tags of the next game if the result is missing.
+	while (p < end)
+	{
+		const char c = *p;
+
+		if (isspace((unsigned char)c))
+		{
+			p++;
+			if (c == '\n' && p < end && *p == '[')
+				break;
+			continue;
+		}
+
+		if (c == '{')
+		{
+			p = std::find(p, end, '}');
+			p += p < end;
+			continue;
+		}
+
+		if (c == ';')
+		{
+			p = std::find(p, end, '\n');
+			continue;
+		}
+
+		// Variations, which may be nested and hold comments.
+		if (c == '(')
+		{
+			int depth = 0;
+			for (; p < end; p++)
+			{
+				if (*p == '{')
+					p = std::find(p, end, '}');
+				if (p >= end)
+					break;
+				if (*p == '(')
+					depth++;
+				else if (*p == ')' && --depth == 0)
+				{
+					p++;
+					break;
+				}
+			}
+			continue;
+		}
+
+		const char *tokenEnd = p;
+		while (tokenEnd < end && !isspace((unsigned char)*tokenEnd) && !strchr("{}();", *tokenEnd))
+			tokenEnd++;
+		std::string token(p, tokenEnd);
+		p = tokenEnd;
+
+		if (token.empty())
+		{
+			p++;
+			continue;
+		}
+
+		if (token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*")
+		{
+			result = token == "1-0" ? WHITE_WINS : token == "0-1" ? BLACK_WINS : token == "*" ? NO_RESULT : DRAW;
+			break;
+		}
+
+		// Annotation glyphs and move numbers, which may be joined to the move, like 12.e4 or 12...e5.
+		if (token[0] == '$')
+			continue;
+
+		size_t start = 0;
+		while (start < token.size() && isdigit((unsigned char)token[start]))
+			start++;
+		if (start > 0 && start < token.size() && token[start] == '.')
+		{
+			while (start < token.size() && token[start] == '.')
+				start++;
+			token.erase(0, start);
+		}
+		else if (start == token.size())
+		{
+			continue;
+		}
+
+		if (token.empty() || !valid || ply >= maxPly)
+			continue;
+
+		const Move move = parseSan(board, turn, token);
+		if (move == Move::none())
+		{
+			valid = false;
+			continue;
+		}
+
+		Record record;
+		record.key = Book::key(board, turn);
+		record.move = Book::encodeMove(move);
+		record.points = turn == Board::WHITE ? 0 : 1;
+		moves.push_back(record);
+
+		board.makeMove(move, turn);
+		turn ^= Board::BLACK;
+		ply++;
+	}
+
+	return valid ? result : NO_RESULT;
+}
+
+// Adds a record to the batch of its shard, which is added to the shard when full.
+void BookBuilder::addRecord(const Record &record, std::vector<Record> (&batches)[SHARDS])
+{
+	const unsigned int shard = (unsigned int)(record.key >> 58) % SHARDS;
+	std::vector<Record> &batch = batches[shard];
+
+	batch.push_back(record);
+	if (batch.size() >= BATCH_SIZE)
+		flush(shard, batch);
+}
+
+// Adds a batch of records to the statistics of its shard and empties it.
+void BookBuilder::flush(const unsigned int shard, std::vector<Record> &batch)
+{
+	std::lock_guard<std::mutex> lock(shards[shard].mutex);
+
+	for (const Record &record : batch)
+	{
+		std::vector<MoveStats> &stats = shards[shard].positions[record.key];
+		auto found = std::find_if(stats.begin(), stats.end(), [&record](const MoveStats &s) { return s.move == record.move; });
+
+		if (found == stats.end())
+		{
+			MoveStats added = { record.move, 0, 0 };
+			stats.push_back(added);
+			found = stats.end() - 1;
+		}
+
+		found->games++;
+		found->points += record.points;
+	}
+
+	batch.clear();
+}
+
+// Replays games reaching the positions of the Polyglot specification and checks the keys recorded for their
+// moves. Returns true if all keys match.
+bool BookBuilder::runSuite(std::ostream &out)
+{
+	BookBuilder builder(1);
+	bool passed = true;
+
+	for (unsigned int i = 0; i < SUITE_SIZE; i++)
+	{
+		const Game &game = SUITE[i];
+		const char *p = game.pgn;
+		std::vector<Record> moves;
+
+		out << "Game " << i + 1 << ": " << std::string(strchr(game.pgn, '1'), strchr(game.pgn, '/') - 2) << std::endl;
+
+		if (builder.replayGame(p, p + strlen(p), moves) == NO_RESULT || moves.size() != GAME_PLIES)
+		{
+			out << "  FAILED, the game cannot be replayed" << std::endl;
+			passed = false;
+			continue;
+		}
+
+		for (size_t ply = 0; ply < moves.size(); ply++)
+		{
+			if (game.keys[ply] == 0)
+				continue;
+
+			const bool match = moves[ply].key == game.keys[ply];
+			out << std::hex << std::setfill('0') << "  ply " << ply + 1 << " key " << std::setw(16) << moves[ply].key
+				<< (match ? " ok" : " FAILED, expected ");
+			if (!match)
+				out << std::setw(16) << game.keys[ply];
+			out << std::dec << std::setfill(' ') << std::endl;
+
+			passed &= match;
+		}
+	}
+
+	out << std::endl << (passed ? "All keys match" : "Some keys do not match") << std::endl;
+	return passed;
+}
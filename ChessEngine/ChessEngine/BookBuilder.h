@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <ostream>
+#include <vector>
+#include <mutex>
+#include <unordered_map>
+#include <atomic>
+#include "Board.h"
+#include "Book.h"
+
+namespace chessengine
+{
+
+	// Builds an opening book from PGN game collections.
+	// A PGN file is memory mapped and cut into chunks at game boundaries. Worker threads take chunks, replay the
+	// games from their SAN moves and record the first plies of every game with its result. The statistics of a
+	// position live in one of SHARDS hash maps, chosen by the position key, so threads seldom wait for each other.
+	// Every book move is weighted by its score over the games it was played in: 2 per win and 1 per draw.
+	// Positions are keyed by their Polyglot key and moves use the Polyglot encoding, so the book can be read by
+	// any Polyglot compatible program.
+	class BookBuilder
+	{
+
+	public:
+
+		static const unsigned int SHARDS = 64;
+		static const unsigned int DEFAULT_MAX_PLY = 30;
+
+		BookBuilder(const unsigned int threads, const unsigned int maxPly = DEFAULT_MAX_PLY);
+		BookBuilder(const BookBuilder &) = delete;
+		BookBuilder &operator=(const BookBuilder &) = delete;
+
+		bool addFile(const std::string &path);
+		bool write(const std::string &path, const unsigned int minGames = 1) const;
+
+		uint64_t gameCount() const;
+		uint64_t skippedCount() const;
+
+		static Move parseSan(Board &board, const color turn, const std::string &san);
+		static bool runSuite(std::ostream &out);
+
+	private:
+
+		// Statistics of a move of a position.
+		struct MoveStats
+		{
+			uint16_t move;		// Book encoding.
+			uint32_t games;
+			uint32_t points;	// 2 per win and 1 per draw, for the side that played the move.
+		};
+
+		// A played move waiting to be added to its shard.
+		struct Record
+		{
+			uint64_t key;
+			uint16_t move;
+			uint8_t points;
+		};
+
+		struct Shard
+		{
+			std::mutex mutex;
+			std::unordered_map<uint64_t, std::vector<MoveStats>> positions;
+		};
+
+		static const unsigned int GAME_PLIES = 8;
+
+		// A test game of GAME_PLIES plies and the Polyglot keys of the positions its moves are played from, 0 where
+		// not known.
+		struct Game
+		{
+			const char *pgn;
+			uint64_t keys[GAME_PLIES];
+		};
+
+		static const unsigned int SUITE_SIZE = 2;
+		static const Game SUITE[SUITE_SIZE];
+
+		// Records kept by a worker per shard before taking the shard lock.
+		static const size_t BATCH_SIZE = 1024;
+
+		// Game results
+		static const int NO_RESULT = -1;
+		static const int BLACK_WINS = 0;
+		static const int DRAW = 1;
+		static const int WHITE_WINS = 2;
+
+		const unsigned int threads;
+		const unsigned int maxPly;
+		Shard shards[SHARDS];
+		std::atomic<uint64_t> games;
+		std::atomic<uint64_t> skipped;
+
+		void parseChunk(const char *begin, const char *end, std::vector<Record> (&batches)[SHARDS]);
+		int replayGame(const char *&p, const char *end, std::vector<Record> &moves);
+		void addRecord(const Record &record, std::vector<Record> (&batches)[SHARDS]);
+		void flush(const unsigned int shard, std::vector<Record> &batch);
+
+	};
+
+}
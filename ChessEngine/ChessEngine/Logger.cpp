@@ -0,0 +1,203 @@
+#include "Logger.h"
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+using namespace chessengine;
+
+static const char *const LEVEL_NAME[4] = { "DEBUG", "INFO", "WARNING", "CRITICAL" };
+
+Logger::Slot *Logger::slots = nullptr;
+std::atomic<size_t> Logger::writePosition(0);
+size_t Logger::readPosition = 0;
+std::atomic<int> Logger::minLevel(Logger::INFO);
+std::atomic<uint64_t> Logger::dropped(0);
+std::atomic<bool> Logger::running(false);
+std::atomic<unsigned int> Logger::activeWriters(0);
+std::thread Logger::writer;
+std::ofstream Logger::file;
+
+// Opens the log file for appending and starts the writer thread. Returns false if the file cannot be opened.
+// The slots are reset after stop(), once no thread is in write() any more and new writers see the logger stopped.
+bool Logger::start(const std::string &path, const int level)
+{
+	stop();
+
+	file.open(path, std::ios::app | std::ios::binary);
+	if (!file)
+		return false;
+
+	if (slots == nullptr)
+		slots = new Slot[CAPACITY];
+
+	for (size_t i = 0; i < CAPACITY; i++)
+	{
+		slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	writePosition.store(0, std::memory_order_relaxed);
+	readPosition = 0;
+	dropped = 0;
+	minLevel = level;
+	running = true;
+	writer = std::thread(run);
+	return true;
+}
+
+// Writes the messages still in the buffer, including those of threads still in write(), stops the writer thread
+// and closes the file. Messages written after the logger is seen stopped are dropped.
+void Logger::stop()
+{
+	if (!writer.joinable())
+		return;
+
+	running = false;
+	writer.join();
+	file.close();
+}
+
+
+void Logger::setLevel(const int level)
+{
+	minLevel = level;
+}
+
+// Queues a message. Returns false if it was dropped because the logger is not running or the buffer is full.
+bool Logger::write(const int level, const std::string &message)
+{
+	if (level < minLevel.load(std::memory_order_relaxed))
+		return false;
+
+	// The writer thread does not stop while a thread that saw the logger running is still here. Both the count and
+	// the running flag are sequentially consistent, so stop() either waits for this thread or it sees the stop.
+	activeWriters.fetch_add(1);
+	const bool queued = running.load() && enqueue(level, message);
+	activeWriters.fetch_sub(1);
+	return queued;
+}
+
+// Copies a message into the next free slot. Returns false if the buffer is full.
+bool Logger::enqueue(const int level, const std::string &message)
+{
+	// Claim the next position. Its slot is free when its sequence equals the position; a lower sequence means
+	// the reader has not yet taken the message written there a round earlier.
+	size_t position = writePosition.load(std::memory_order_relaxed);
+	Slot *slot;
+
+	while (true)
+	{
+		slot = &slots[position & (CAPACITY - 1)];
+		const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+		const intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+
+		if (difference == 0)
+		{
+			if (writePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (difference < 0)
+		{
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		else
+		{
+			position = writePosition.load(std::memory_order_relaxed);
+		}
+	}
+
+	slot->level = level < DEBUG ? DEBUG : level > CRITICAL ? CRITICAL : level;
+	slot->time = std::chrono::system_clock::now();
+	slot->length = (unsigned int)(message.size() < MESSAGE_SIZE ? message.size() : MESSAGE_SIZE);
+	memcpy(slot->text, message.data(), slot->length);
+
+	// Hand the slot to the reader.
+	slot->sequence.store(position + 1, std::memory_order_release);
+	return true;
+}
+
+// Messages dropped because the buffer was full.
+uint64_t Logger::droppedCount()
+{
+	return dropped;
+}
+
+// Writer thread: collects all queued messages into one batch, writes it with a single call, and sleeps while
+// there is nothing to write. Once stopped, it waits for the threads still in write() and returns when every
+// claimed position has been written, so that no queued message is lost.
+void Logger::run()
+{
+	std::string batch;
+	uint64_t reportedDrops = 0;
+
+	while (true)
+	{
+		// No thread can claim a position once the logger is stopped and no writer is active.
+		const bool stopped = !running.load() && activeWriters.load() == 0;
+
+		// A batch holds at most one buffer of messages, so that busy writers cannot hold up the file.
+		batch.clear();
+		for (unsigned int i = 0; i < CAPACITY && read(batch); i++)
+		{
+		}
+
+		const uint64_t drops = dropped.load(std::memory_order_relaxed);
+		if (drops != reportedDrops)
+		{
+			batch += std::to_string(drops - reportedDrops) + " log messages dropped\n";
+			reportedDrops = drops;
+		}
+
+		if (!batch.empty())
+		{
+			file.write(batch.data(), (std::streamsize)batch.size());
+			file.flush();
+		}
+		else if (stopped && readPosition == writePosition.load(std::memory_order_relaxed))
+		{
+			return;
+		}
+		else
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(IDLE_MS));
+		}
+	}
+}
+
+// Appends the next message to the batch and frees its slot. Returns false if the buffer is empty.
+bool Logger::read(std::string &batch)
+{
+	Slot &slot = slots[readPosition & (CAPACITY - 1)];
+
+	if (slot.sequence.load(std::memory_order_acquire) != readPosition + 1)
+		return false;
+
+	format(slot, batch);
+
+	// The slot is free for the writer of the position one round later.
+	slot.sequence.store(readPosition + CAPACITY, std::memory_order_release);
+	readPosition++;
+	return true;
+}
+
+// Appends a message as a line: local time with milliseconds, level and text.
+void Logger::format(const Slot &slot, std::string &batch)
+{
+	const std::time_t seconds = std::chrono::system_clock::to_time_t(slot.time);
+	const long long milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(slot.time.time_since_epoch()).count() % 1000;
+
+	std::tm local;
+#ifdef _WIN32
+	localtime_s(&local, &seconds);
+#else
+	localtime_r(&seconds, &local);
+#endif
+
+	char prefix[48];
+	const size_t length = strftime(prefix, sizeof(prefix), "%Y-%m-%d %H:%M:%S", &local);
+	snprintf(prefix + length, sizeof(prefix) - length, ".%03lld %-8s ", milliseconds, LEVEL_NAME[slot.level]);
+
+	batch += prefix;
+	batch.append(slot.text, slot.length);
+	batch += '\n';
+}
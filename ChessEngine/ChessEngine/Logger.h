@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <fstream>
+
+namespace chessengine
+{
+
+	// Asynchronous log file writer.
+	// Any thread may write messages, which are copied into a fixed ring buffer without locks or allocation. A
+	// background thread takes them out, prefixes the time and level, and appends them to the file in batches, so
+	// the writing threads never wait for the disk. When the buffer is full, messages are dropped and counted
+	// rather than blocking the writer.
+	class Logger
+	{
+
+	public:
+
+		// Levels, messages below the level set are ignored.
+
+		static const int DEBUG = 0;
+		static const int INFO = 1;
+		static const int WARNING = 2;
+		static const int CRITICAL = 3;
+
+		static const unsigned int CAPACITY = 1024;		// Messages in the ring buffer, a power of two.
+		static const unsigned int MESSAGE_SIZE = 240;	// Longer messages are cut.
+
+		static bool start(const std::string &path, const int level = INFO);
+		static void stop();
+		static void setLevel(const int level);
+		static bool write(const int level, const std::string &message);
+		static uint64_t droppedCount();
+
+	private:
+
+		// A message in the ring buffer. The sequence number tells whether the slot is free for the writer of a
+		// position, or holds the message of a position for the reader.
+		struct Slot
+		{
+			std::atomic<size_t> sequence;
+			int level;
+			std::chrono::system_clock::time_point time;
+			unsigned int length;
+			char text[MESSAGE_SIZE];
+		};
+
+		// Idle time of the writer thread when the buffer is empty.
+		static const unsigned int IDLE_MS = 5;
+
+		static Slot *slots;
+		static std::atomic<size_t> writePosition;
+		static size_t readPosition;
+		static std::atomic<int> minLevel;
+		static std::atomic<uint64_t> dropped;
+		static std::atomic<bool> running;
+		static std::atomic<unsigned int> activeWriters;	// Threads inside write() that saw the logger running.
+		static std::thread writer;
+		static std::ofstream file;
+
+		static bool enqueue(const int level, const std::string &message);
+		static void run();
+		static bool read(std::string &batch);
+		static void format(const Slot &slot, std::string &batch);
+
+	};
+
+}
@@ -0,0 +1,127 @@
+#include "MappedFile.h"
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace chessengine;
+
+#ifdef _WIN32
+
+MappedFile::MappedFile()
+	: mapping(nullptr), length(0), file(INVALID_HANDLE_VALUE), mappingObject(nullptr)
+{
+}
+
+#else
+
+MappedFile::MappedFile()
+	: mapping(nullptr), length(0)
+{
+}
+
+#endif
+
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+// Maps the file at the given path, replacing any file mapped before. Returns false if the file cannot be opened
+// or is empty.
+bool MappedFile::open(const std::string &path)
+{
+	close();
+
+#ifdef _WIN32
+	file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		close();
+		return false;
+	}
+
+	mappingObject = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mappingObject == nullptr)
+	{
+		close();
+		return false;
+	}
+
+	mapping = static_cast<const uint8_t *>(MapViewOfFile(mappingObject, FILE_MAP_READ, 0, 0, 0));
+	if (mapping == nullptr)
+	{
+		close();
+		return false;
+	}
+
+	length = (size_t)fileSize.QuadPart;
+#else
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat status;
+	if (fstat(fd, &status) != 0 || status.st_size == 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+	void *address = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+
+	if (address == MAP_FAILED)
+		return false;
+
+	mapping = static_cast<const uint8_t *>(address);
+	length = (size_t)status.st_size;
+#endif
+
+	return true;
+}
+
+
+void MappedFile::close()
+{
+#ifdef _WIN32
+	if (mapping != nullptr)
+		UnmapViewOfFile(mapping);
+	if (mappingObject != nullptr)
+		CloseHandle(mappingObject);
+	if (file != INVALID_HANDLE_VALUE)
+		CloseHandle(file);
+
+	mappingObject = nullptr;
+	file = INVALID_HANDLE_VALUE;
+#else
+	if (mapping != nullptr)
+		munmap(const_cast<uint8_t *>(mapping), length);
+#endif
+
+	mapping = nullptr;
+	length = 0;
+}
+
+// Exchanges the mappings of two objects, so that a file can be mapped and checked before it replaces another.
+void MappedFile::swap(MappedFile &other)
+{
+	std::swap(mapping, other.mapping);
+	std::swap(length, other.length);
+#ifdef _WIN32
+	std::swap(file, other.file);
+	std::swap(mappingObject, other.mappingObject);
+#endif
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace chessengine
+{
+
+	// Read-only memory mapping of a whole file. The operating system pages the file in on demand and shares the
+	// pages between all threads and processes mapping it, so large data files need neither loading nor copying.
+	class MappedFile
+	{
+
+	public:
+
+		MappedFile();
+		~MappedFile();
+		MappedFile(const MappedFile &) = delete;
+		MappedFile &operator=(const MappedFile &) = delete;
+
+		bool open(const std::string &path);
+		void close();
+		void swap(MappedFile &other);
+
+		inline bool isOpen() const
+		{
+			return mapping != nullptr;
+		}
+
+		inline const uint8_t *data() const
+		{
+			return mapping;
+		}
+
+		inline size_t size() const
+		{
+			return length;
+		}
+
+	private:
+
+		const uint8_t *mapping;
+		size_t length;
+
+#ifdef _WIN32
+		void *file;			// File and mapping object handles.
+		void *mappingObject;
+#endif
+
+	};
+
+}
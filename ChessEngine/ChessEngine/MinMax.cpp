@@ -9,22 +9,22 @@ void MinMax::applyMinMax(Node *root)
 	// Recursive call
 	for (unsigned int i = 0; i < nc; i++)
 	{
-		applyMinMax(root->childrenPtr[i]);
+		applyMinMax(&root->childrenPtr[i]);
 	}
 
 	// Fetch values from children
 	if (nc > 0)
 	{
-		short best = root->childrenPtr[0]->value;
+		short best = root->childrenPtr[0].value;
 		short childVal;
 
 		// White -> max
 		if (root->getColor() == Board::WHITE)
 		{
-			best = root->childrenPtr[0]->value;
+			best = root->childrenPtr[0].value;
 			for (unsigned int i = 0; i < nc; i++)
 			{
-				childVal = root->childrenPtr[i]->value;
+				childVal = root->childrenPtr[i].value;
 				if (childVal > best)
 				{
 					best = childVal;
@@ -36,7 +36,7 @@ void MinMax::applyMinMax(Node *root)
 		{
 			for (unsigned int i = 0; i < nc; i++)
 			{
-				childVal = root->childrenPtr[i]->value;
+				childVal = root->childrenPtr[i].value;
 				if (childVal < best)
 				{
 					best = childVal;
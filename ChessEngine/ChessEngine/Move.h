@@ -0,0 +1,111 @@
+#pragma once
+#include <cstdint>
+
+namespace chessengine
+{
+	typedef int8_t rank;		// Board rank.
+	typedef int8_t file;		// Board file.
+	typedef int8_t piece_t;		// Piece type.
+	typedef int8_t color;		// Color (white/black). color XOR 6 to toggle between white and black. (color ^ Board::BLACK)
+	typedef uint8_t piece_p;	// Piece position.
+
+	// A move packed into 16 bits: origin (bits 0-5), destination (bits 6-11), promotion piece (bits 12-13)
+	// and move kind (bits 14-15). Castling is encoded as the king's move. The all-zero move is used as "no move",
+	// and the packed value is what the transposition table stores.
+	struct Move
+	{
+		// Move kinds
+
+		static const uint16_t NORMAL = 0;
+		static const uint16_t PROMOTION = 1 << 14;
+		static const uint16_t EN_PASSANT = 2 << 14;
+		static const uint16_t CASTLING = 3 << 14;
+
+		uint16_t data;
+
+		Move() = default;
+
+		constexpr explicit Move(const uint16_t data)
+			: data(data)
+		{
+		}
+
+		// promotion is the type of the promoted piece, ROOK (1) to QUEEN (4).
+		constexpr Move(const piece_p pos, const piece_p dest, const uint16_t kind = NORMAL, const piece_t promotion = 1)
+			: data((uint16_t)(pos | dest << 6 | (promotion - 1) << 12 | kind))
+		{
+		}
+
+		static constexpr Move none()
+		{
+			return Move(0);
+		}
+
+		inline piece_p pos() const
+		{
+			return data & 0x3F;
+		}
+
+		inline piece_p dest() const
+		{
+			return (data >> 6) & 0x3F;
+		}
+
+		inline uint16_t kind() const
+		{
+			return data & 0xC000;
+		}
+
+		// Type of the promoted piece, only meaningful for promotions.
+		inline piece_t promotion() const
+		{
+			return (piece_t)(((data >> 12) & 3) + 1);
+		}
+
+		inline uint16_t pack() const
+		{
+			return data;
+		}
+
+		inline bool operator==(const Move &other) const
+		{
+			return data == other.data;
+		}
+
+		inline bool operator!=(const Move &other) const
+		{
+			return data != other.data;
+		}
+	};
+
+	// Fixed capacity list of moves, meant to live on the stack of the generating function.
+	struct MoveList
+	{
+		// Upper bound of the number of moves in a position.
+		static const unsigned int CAPACITY = 256;
+
+		Move moves[CAPACITY];
+		unsigned int size = 0;
+
+		inline void add(const Move move)
+		{
+			moves[size++] = move;
+		}
+
+		inline const Move &operator[](const unsigned int index) const
+		{
+			return moves[index];
+		}
+
+		inline const Move *begin() const
+		{
+			return moves;
+		}
+
+		inline const Move *end() const
+		{
+			return moves + size;
+		}
+	};
+
+}
@@ -1,75 +1,70 @@
+#include <intrin.h>
 #include "MoveGenerator.h"
 #include "Bitops.h"
 #include "Validator.h"
 #include "MinMax.h"
+#include "SlidingAttacks.h"
+#include "AttackTables.h"
 
 using namespace chessengine;
 
-std::mutex global_queue_mutex;
-std::queue<Node*> global_queue;
-
-MoveGenerator::MoveGenerator(const unsigned int n_threads, const unsigned int max_depth, const Board &board)
-	: MAX_THREADS(n_threads), activeThreads(0), baseBoard(board), MAX_DEPTH(max_depth)
+MoveGenerator::MoveGenerator(const unsigned int n_threads, const unsigned int max_depth, const Board &board, TranspositionTable &table)
+	: MAX_THREADS(n_threads), baseBoard(board), MAX_DEPTH(max_depth), table(table), deques(nullptr), pendingTasks(0), queuedTasks(0), idleThreads(0)
 {
+	arenas = new NodeArena[MAX_THREADS > 0 ? MAX_THREADS : 1];
 }
 
 
 MoveGenerator::~MoveGenerator()
 {
+	delete[] arenas;
 }
 
 
 Node *MoveGenerator::createTree(const color turnColor)
 {
 	clock_t start_t = clock();
-	Node *root = new Node();
+
+	// Release the tree of the previous call.
+	for (unsigned int i = 0; i < (MAX_THREADS > 0 ? MAX_THREADS : 1); i++)
+	{
+		arenas[i].reset();
+	}
+
+	Node *root = arenas[0].allocate(1);
 	root->setColor(turnColor);
-	root->board = baseBoard;
+	table.newSearch();
 
 	if (MAX_DEPTH < 3 || MAX_THREADS == 1) // Skip multithreading if depth < 3
 	{
 		std::cout << "SINGLETHREAD MODE" << std::endl;
-		processNodeFull(root);
+		Board board = baseBoard;
+		processNodeFull(root, board, arenas[0], nullptr);
 	}
 	else
 	{
 		std::cout << "MULTITHREAD MODE (" << MAX_THREADS << " threads)" << std::endl;
-		global_queue.push(root);
-
-		Node *head = nullptr;
-
-		while (global_queue.size() < MAX_THREADS)	// While num_of_leaf_nodes < num_of_threads
-		{
-			head = global_queue.front();
-			global_queue.pop();
 
-			processNode(head);	// create more nodes
-
-			for (unsigned int i = 0; i < head->fields.num_childs; i++)
-			{
-				global_queue.push(head->childrenPtr[i]);
-			}
-
-			if (global_queue.empty())
-			{
-				// no legal moves => checkmate
-				std::cout << "Queue empty" << std::endl;
-				return root;
-			}
-		}
+		// The root is the first task. Workers split subtrees whenever threads are idle, so the tree is
+		// divided dynamically instead of into a fixed number of subtrees up front.
+		deques = new WorkStealingDeque[MAX_THREADS];
+		deques[0].push(root);
+		pendingTasks = 1;
+		queuedTasks = 1;
+		idleThreads = MAX_THREADS;
 
 		std::vector<std::thread*> threads;
-		std::vector<Node*> startNodes;
 		threads.resize(MAX_THREADS);
-		startNodes.resize(MAX_THREADS);
-		
+
 		for (unsigned int i = 0; i < MAX_THREADS; i++) {
-			startNodes[i] = global_queue.front();
-			global_queue.pop();
+			threads[i] = createThreadWorker(i);
 		}
 
-		for (unsigned int i = 0; i < MAX_THREADS; i++) {
-			threads[i] = createThreadWorker(startNodes[i]);
+		// Progress is read from the counters, so the workers never wait for console output.
+		while (pendingTasks > 0)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			std::cout << "\r" << pendingTasks << " unexplored subtrees    ";
 		}
 
 		for (unsigned int i = 0; i < MAX_THREADS; i++) {
@@ -78,6 +73,10 @@ Node *MoveGenerator::createTree(const color turnColor)
 			threads[i] = nullptr;
 		}
 
+		delete[] deques;
+		deques = nullptr;
+
+		// Resolve the values of the split nodes, which were not collapsed by the workers.
 		MinMax::applyMinMax(root);
 	}
 
@@ -87,180 +86,416 @@ Node *MoveGenerator::createTree(const color turnColor)
 	return root;
 }
 
-// Creates a thread for processing a node.
-std::thread *MoveGenerator::createThreadWorker(Node *root)
+// Creates a thread for a worker of the tree generation.
+std::thread *MoveGenerator::createThreadWorker(const unsigned int worker)
 {
-	std::thread *worker = new std::thread(&MoveGenerator::processNodeStart, this, root);
-	return worker;
+	std::thread *thread = new std::thread(&MoveGenerator::processNodeStart, this, worker);
+	return thread;
 }
 
-void chessengine::MoveGenerator::processNodeStart(Node *root)
+// Worker loop: expands subtrees from the own deque, or stolen from other workers, until all subtrees are done.
+void chessengine::MoveGenerator::processNodeStart(const unsigned int worker)
 {
-	while (root != nullptr)
+	Node *root = nullptr;
+
+	while (pendingTasks > 0)
 	{
-		processNodeFull(root);
+		if (!takeWork(worker, root))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		idleThreads--;
 
-		global_queue_mutex.lock();	 // START CRITICAL SECTION
+		// Replay the moves leading to the subtree on a private board.
+		Board board = baseBoard;
+		root->performAllStoredMoves(board);
+		processNodeFull(root, board, arenas[worker], &deques[worker]);
 
-		if (global_queue.empty())
+		idleThreads++;
+		pendingTasks--;
+	}
+}
+
+// Takes a subtree from the worker's own deque, or steals one from another worker.
+bool MoveGenerator::takeWork(const unsigned int worker, Node *&node)
+{
+	for (unsigned int i = 0; i < MAX_THREADS; i++)
+	{
+		const unsigned int victim = (worker + i) % MAX_THREADS;
+
+		if (victim == worker ? deques[victim].pop(node) : deques[victim].steal(node))
 		{
-			global_queue_mutex.unlock(); // END CRITICAL SECTION
-			root = nullptr;
-			break;
+			queuedTasks--;
+			return true;
 		}
-		root = global_queue.front();
-		global_queue.pop();
-		std::cout << "\r" << global_queue.size() << " unexplored subtrees    ";
-
-		global_queue_mutex.unlock(); // END CRITICAL SECTION
 	}
+
+	return false;
 }
 
-// Create subtree from node.
-void MoveGenerator::processNodeFull(Node *root)
+// Create subtree from node. The board holds the position of the node, and is restored before returning.
+// With a deque, the remaining children of a large subtree are handed to idle workers through the deque. The
+// node is then left expanded, and false is returned, as its value is only known once the tree is complete.
+bool MoveGenerator::processNodeFull(Node *root, Board &board, NodeArena &arena, WorkStealingDeque *deque)
 {
-	//root->board.printFull();
+	const uint8_t remainingDepth = MAX_DEPTH - root->fields.depth;
+	const uint64_t key = board.hash(root->getColor());
+	uint16_t bestMove = 0;
+	bool complete = true;
+
+	// A stored result of at least the same depth makes expanding the subtree unnecessary.
+	TranspositionTable::Entry entry;
+	if (root->fields.depth && remainingDepth && table.probe(key, entry) && entry.depth >= remainingDepth)
+	{
+		root->value = relativeScore(entry.score, root->getColor());
+		root->fields.validated = 1;
+		return true;
+	}
+
+	// The subtree is released by rewinding the arena to here once it is collapsed.
+	const NodeArena::Mark mark = arena.mark();
+
 	if (root->fields.depth < MAX_DEPTH)
 	{
 		// create child nodes
-		processNode(root);
+		processNode(root, board, arena);
+
+		const color nodeColor = root->getColor();
 
 		for (unsigned int i = 0; i < root->fields.num_childs; i++)
 		{
+			Node *child = &root->childrenPtr[i];
+
+			// split when more threads are idle than there are queued subtrees
+			if (deque && remainingDepth > MIN_SPLIT_DEPTH && idleThreads > queuedTasks)
+			{
+				for (unsigned int j = i; j < root->fields.num_childs; j++)
+				{
+					pendingTasks++;
+					queuedTasks++;
+					deque->push(&root->childrenPtr[j]);
+				}
+				complete = false;
+				break;
+			}
+
 			// recursively expand tree
-			processNodeFull(root->childrenPtr[i]);
+			board.makeMove(child->move, nodeColor);
+			complete &= processNodeFull(child, board, arena, deque);
+			board.unmakeMove();
 		}
 	}
+
+	if (!complete)
+	{
+		return false;
+	}
 	
 	if (root->fields.num_childs) // num_childs > 0
 	{
 		unsigned int num_childs = root->fields.num_childs;
-		short bestValue = root->childrenPtr[0]->value;
+		short bestValue = root->childrenPtr[0].value;
 		short childValue;
+		unsigned int best = 0;
 
 		if (root->fields.color == Board::WHITE)
 		{
 			for (unsigned int i = 0; i < num_childs; i++)
 			{
-				childValue = root->childrenPtr[i]->value;
-				if (childValue > bestValue) bestValue = childValue;
+				childValue = root->childrenPtr[i].value;
+				if (childValue > bestValue) { bestValue = childValue; best = i; }
 			}
 		}
 		else // BLACK
 		{
 			for (unsigned int i = 0; i < num_childs; i++)
 			{
-				childValue = root->childrenPtr[i]->value;
-				if (childValue < bestValue) bestValue = childValue;
+				childValue = root->childrenPtr[i].value;
+				if (childValue < bestValue) { bestValue = childValue; best = i; }
 			}
 		}
 		
 		root->value = bestValue;
+		bestMove = root->childrenPtr[best].move.pack();
 
 		if (root->fields.depth)	// depth > 0
 		{
-			for (unsigned int i = 0; i < num_childs; i++)
-			{
-				delete root->childrenPtr[i];
-				root->childrenPtr[i] = nullptr;
-			}
-
 			root->fields.num_childs = 0;
-
-			delete[] root->childrenPtr;
 			root->childrenPtr = nullptr;
+			arena.rewind(mark);
 		}
 	}
 	else // num_childs == 0
 	{
-		root->validate();
+		root->validate(board);
 	}
 
+	if (remainingDepth)
+	{
+		table.store(key, bestMove, relativeScore(root->value, root->getColor()), remainingDepth, TranspositionTable::BOUND_EXACT);
+	}
+
+	return true;
 }
 
-// Create child nodes.
-void MoveGenerator::processNode(Node *node)
+// Create child nodes. The board holds the position of the node.
+// The moves are generated legal, so the children can be allocated as one contiguous table right away.
+void MoveGenerator::processNode(Node *node, Board &board, NodeArena &arena)
 {
-	// The board being processed.
-	Board board = node->board;
-
 	// the processing color
 	const color nodeColor = node->getColor();
 
-	// true if current player is in check.
-	const bool check = board.isKingCheck(nodeColor);
+	MoveList moves;
+	generateMoves(board, nodeColor, moves);
 
-	// Counter of legal moves.
-	unsigned int num_legalMoves = 0;
+	const unsigned int num_legalMoves = moves.size;
 
-	// Iterate through piece types.
-	for (piece_t type = Board::PAWN; type <= Board::KING; type++)
+	if (num_legalMoves > 0)
 	{
-		// Table containing the position of every piece of respective type.
-		unsigned int pps_count;
-		uint8_t *pps = bit_i(board.bitboard[nodeColor + type], pps_count);
+		Node *children = arena.allocate(num_legalMoves);
 
-		// Iterate through this vector
-		for (unsigned int i = 0; i < pps_count; i++)
+		for (unsigned int i = 0; i < num_legalMoves; i++)
 		{
-			// A piece position
-			piece_p piecePos = pps[i];
+			// Set child fields.
+			Node &child = children[i];
+			child.setColor(nodeColor ^ Board::BLACK);
+			child.fields.depth = node->fields.depth + 1;
+			child.move = moves[i];
+		}
 
-			// Movement mask for the piece being processed.
-			uint64_t pieceMovMask = pieceMovementMask(piecePos, type, nodeColor, board);
+		node->setChildren(children, num_legalMoves);
+	}
+	// no legal moves and check => checkmate
+	else if (board.isKingCheck(nodeColor))
+	{
+		node->value = node->getColor() == Board::WHITE ? SHRT_MIN : SHRT_MAX;
+		node->fields.validated = 1;
+	}
+}
 
-			// Positions where said piece can move.
-			unsigned int pds_count;
-			uint8_t *pds = bit_i(pieceMovMask, pds_count);
 
-			// Iterate through the destinations table.
-			for (unsigned int j = 0; j < pds_count; j++)
-			{
-				// Move destination.
-				piece_p pieceDest = pds[j];
+// Converts between node values (positive favours white) and scores relative to the side to move, as the
+// transposition table holds them. The conversion is its own inverse, except that SHRT_MIN maps to -SHRT_MAX.
+short MoveGenerator::relativeScore(const short value, const color turn)
+{
+	if (turn == Board::WHITE)
+		return value;
+
+	return value == SHRT_MIN ? SHRT_MAX : -value;
+}
+
+// Adds all legal moves of a color to the move list, including castling, en passant and promotions to every
+// piece.
+void MoveGenerator::generateMoves(const Board &board, const color turn, MoveList &moves)
+{
+	generateLegal(board, turn, false, moves);
+}
+
+// Adds the legal captures and queen promotions of a color to the move list.
+// Quiet moves are masked out per piece, so they are never generated.
+void MoveGenerator::generateCaptures(const Board &board, const color turn, MoveList &moves)
+{
+	generateLegal(board, turn, true, moves);
+}
+
+// Legal move generation. Checkers and pinned pieces are determined once: a pinned piece may only move along the
+// line through its king, and in check the other pieces may only capture the checker or block its line (evasion
+// mode). The king may not move to an attacked square. Only en passant, which removes two pieces from a rank,
+// needs its own test, so no move has to be made to find out whether it is legal.
+void MoveGenerator::generateLegal(const Board &board, const color turn, const bool capturesOnly, MoveList &moves)
+{
+	const color enemy = turn ^ Board::BLACK;
+	const uint64_t occupancy = board.positionMask();
+	const uint64_t enemies = board.colorPositionMask(enemy);
+	const uint64_t promotionRank = turn == Board::WHITE ? 0xFFui64 << 56 : 0xFFui64;
+
+	uint64_t kingMask = board.bitboard[turn + Board::KING];
+	const piece_p king = popLSB(kingMask);
+	const uint64_t checkers = board.attackers(king, enemy, occupancy);
+	const uint64_t pinned = pinnedPieces(board, turn, king);
+
+	// King moves. The king is removed from the occupancy, so that it does not hide the squares behind it on the
+	// line of a checking slider.
+	const uint64_t withoutKing = occupancy ^ (1ui64 << king);
+	uint64_t kingDestinations = pieceMovementMask(king, Board::KING, turn, board) & (capturesOnly ? enemies : ~0ui64);
+
+	while (kingDestinations)
+	{
+		const piece_p dest = popLSB(kingDestinations);
+
+		if (!board.attackers(dest, enemy, withoutKing))
+			moves.add(Move(king, dest));
+	}
+
+	// in double check only the king can move
+	if (checkers & (checkers - 1))
+		return;
 
-				// Copy board and perform the move.
-				Board candidateMove = board;
-				candidateMove.movePiece(piecePos, type, nodeColor, pieceDest);
+	uint64_t targets = ~0ui64;
 
-				// The move must set the player out of check in order to be a valid move.
-				if (!candidateMove.isKingCheck(nodeColor)) {
-					// Create the child node.
-					Node *child = new Node();
+	if (checkers)
+	{
+		unsigned long checker;
+		_BitScanForward64(&checker, checkers);
+		targets = checkers | AttackTables::BETWEEN[king][checker];
+	}
+	else if (!capturesOnly)
+	{
+		addCastling(board, turn, moves);
+	}
 
-					// Set child fields.
-					child->setColor(nodeColor ^ Board::BLACK);
-					child->fields.depth = node->fields.depth + 1;
-					child->fields.position = piecePos;
-					child->fields.destination = pieceDest;
-					child->fields.piece_t = type;
-					child->board = candidateMove;
+	const uint64_t pawnTargets = capturesOnly ? targets & (enemies | promotionRank) : targets;
 
-					// Add child to node.
-					node->addChild(child);
+	if (capturesOnly)
+		targets &= enemies;
 
-					// Increment legal moves counter.
-					num_legalMoves++;
+	for (piece_t type = Board::PAWN; type < Board::KING; type++)
+	{
+		uint64_t pieces = board.bitboard[turn + type];
 
-				}
+		while (pieces)
+		{
+			const piece_p pos = popLSB(pieces);
+			uint64_t destinations = pieceMovementMask(pos, type, turn, board) & (type == Board::PAWN ? pawnTargets : targets);
+
+			if (pinned & (1ui64 << pos))
+				destinations &= AttackTables::LINE[king][pos];
+
+			if (type == Board::PAWN)
+			{
+				addPawnMoves(pos, destinations, !capturesOnly, moves);
+				continue;
 			}
 
-			delete[] pds;
-			pds = nullptr;
+			while (destinations)
+			{
+				moves.add(Move(pos, popLSB(destinations)));
+			}
 		}
+	}
+
+	addEnPassant(board, turn, king, checkers, moves);
+}
+
+// Own pieces that are the only piece between the king and an enemy slider on the same line.
+uint64_t MoveGenerator::pinnedPieces(const Board &board, const color turn, const piece_p king)
+{
+	const color enemy = turn ^ Board::BLACK;
+	const uint64_t occupancy = board.positionMask();
+	const uint64_t queens = board.bitboard[enemy + Board::QUEEN];
+	uint64_t pinned = 0;
+
+	// enemy sliders that would attack the king on an empty board
+	uint64_t snipers = (SlidingAttacks::rook(king, 0) & (board.bitboard[enemy + Board::ROOK] | queens))
+		| (SlidingAttacks::bishop(king, 0) & (board.bitboard[enemy + Board::BISHOP] | queens));
 
-		delete[] pps;
-		pps = nullptr;
+	while (snipers)
+	{
+		const uint64_t between = AttackTables::BETWEEN[king][popLSB(snipers)] & occupancy;
+
+		if (between && !(between & (between - 1)) && (between & board.colorPositionMask(turn)))
+			pinned |= between;
 	}
 
-	// no legal moves and check => checkmate
-	if (num_legalMoves == 0 && check)
+	return pinned;
+}
+
+// Adds the moves of a pawn to the given destinations. Moves to the last rank
+// promote to a queen, and with allPromotions also to a rook, bishop and knight.
+void MoveGenerator::addPawnMoves(const piece_p pos, uint64_t destinations, const bool allPromotions, MoveList &moves)
+{
+	while (destinations)
 	{
-		node->value = node->getColor() == Board::WHITE ? SHRT_MIN : SHRT_MAX;
-		node->fields.validated = 1;
+		const piece_p dest = popLSB(destinations);
+		const rank destRank = dest / 8;
+
+		if (destRank == Board::RANK_8 || destRank == Board::RANK_1)
+		{
+			moves.add(Move(pos, dest, Move::PROMOTION, Board::QUEEN));
+
+			if (allPromotions)
+			{
+				moves.add(Move(pos, dest, Move::PROMOTION, Board::ROOK));
+				moves.add(Move(pos, dest, Move::PROMOTION, Board::BISHOP));
+				moves.add(Move(pos, dest, Move::PROMOTION, Board::KNIGHT));
+			}
+		}
+		else
+		{
+			moves.add(Move(pos, dest));
+		}
 	}
 }
 
+// Adds the legal en passant captures of a color. The captured pawn and the capturing pawn both leave the
+// rank, so the king is tested for slider attacks on the resulting occupancy, and any other checker must be the
+// captured pawn.
+void MoveGenerator::addEnPassant(const Board &board, const color turn, const piece_p king, const uint64_t checkers, MoveList &moves)
+{
+	const piece_p target = board.enPassantSquare();
+
+	if (target == Board::NO_SQUARE)
+		return;
+
+	const color enemy = turn ^ Board::BLACK;
+	const uint64_t captured = 1ui64 << (turn == Board::WHITE ? target - 8 : target + 8);
+	const uint64_t queens = board.bitboard[enemy + Board::QUEEN];
+	const uint64_t rooks = board.bitboard[enemy + Board::ROOK] | queens;
+	const uint64_t bishops = board.bitboard[enemy + Board::BISHOP] | queens;
+
+	if (checkers & ~captured & ~(rooks | bishops))
+		return;
+
+	// the pawns that attack the target are found from the squares an enemy pawn on it would attack
+	uint64_t pawns = AttackTables::pawn(target, enemy) & board.bitboard[turn + Board::PAWN];
+
+	while (pawns)
+	{
+		const piece_p pos = popLSB(pawns);
+		const uint64_t occupancy = (board.positionMask() ^ (1ui64 << pos) ^ captured) | (1ui64 << target);
+
+		if (!(SlidingAttacks::rook(king, occupancy) & rooks) && !(SlidingAttacks::bishop(king, occupancy) & bishops))
+			moves.add(Move(pos, target, Move::EN_PASSANT));
+	}
+}
+
+// Adds the castling moves of a color. The king may not castle out of, through or into check.
+void MoveGenerator::addCastling(const Board &board, const color color, MoveList &moves)
+{
+	const uint8_t rights = board.castlingRights() & (color == Board::WHITE
+		? Board::WHITE_KINGSIDE | Board::WHITE_QUEENSIDE
+		: Board::BLACK_KINGSIDE | Board::BLACK_QUEENSIDE);
+
+	if (!rights)
+		return;
+
+	const piece_p king = color == Board::WHITE ? 4 : 60;
+	const uint64_t occupancy = board.positionMask();
+	const uint64_t rooks = board.bitboard[color + Board::ROOK];
+
+	if (board.pieceAt(king) != color + Board::KING || board.isSquareAttacked(king, color ^ Board::BLACK))
+		return;
+
+	if ((rights & (Board::WHITE_KINGSIDE | Board::BLACK_KINGSIDE))
+		&& (rooks & 1ui64 << (king + 3))
+		&& !(occupancy & (3ui64 << (king + 1)))
+		&& !board.isSquareAttacked(king + 1, color ^ Board::BLACK)
+		&& !board.isSquareAttacked(king + 2, color ^ Board::BLACK))
+	{
+		moves.add(Move(king, king + 2, Move::CASTLING));
+	}
+
+	if ((rights & (Board::WHITE_QUEENSIDE | Board::BLACK_QUEENSIDE))
+		&& (rooks & 1ui64 << (king - 4))
+		&& !(occupancy & (7ui64 << (king - 3)))
+		&& !board.isSquareAttacked(king - 1, color ^ Board::BLACK)
+		&& !board.isSquareAttacked(king - 2, color ^ Board::BLACK))
+	{
+		moves.add(Move(king, king - 2, Move::CASTLING));
+	}
+}
 
 void MoveGenerator::printstat(const unsigned int &depth, const clock_t &start_t)
 {
@@ -278,7 +513,7 @@ uint64_t MoveGenerator::pieceMovementMask(const piece_p pos, const piece_t type,
 
 	switch (type) {
 	case Board::PAWN:
-		movementMask = pawn(pos, color, pieceMask, board.colorPositionMask(color ^ Board::BLACK));
+		movementMask = pawn(pos, color, pieceMask, pieceMask & ~colorMask);
 		break;
 
 	case Board::ROOK:
@@ -290,7 +525,7 @@ uint64_t MoveGenerator::pieceMovementMask(const piece_p pos, const piece_t type,
 		break;
 
 	case Board::KNIGHT:
-		movementMask = knight(pos) & ~board.colorPositionMask(color);
+		movementMask = knight(pos) & ~colorMask;
 		break;
 
 	case Board::QUEEN:
@@ -298,7 +533,7 @@ uint64_t MoveGenerator::pieceMovementMask(const piece_p pos, const piece_t type,
 		break;
 
 	case Board::KING:
-		movementMask = king(pos) & ~board.colorPositionMask(color);
+		movementMask = king(pos) & ~colorMask;
 		break;
 	}
 
@@ -309,7 +544,6 @@ uint64_t MoveGenerator::pieceMovementMask(const piece_p pos, const piece_t type,
 uint64_t MoveGenerator::pawn(const piece_p pos, const color color, const uint64_t pieceMask, const uint64_t otherColorMask)
 {
 	uint64_t movMask = 0x100;
-	uint64_t capMask = 0x280;
 	uint64_t posMask = 1ui64 << pos;
 	rank rank = pos / 8;
 
@@ -325,13 +559,10 @@ uint64_t MoveGenerator::pawn(const piece_p pos, const color color, const uint64_
 
 		else if ((pieceMask & (posMask << 16)))
 			movMask &= ~(posMask << 16);
-
-		capMask <<= pos;
 	}
 	else
 	{
 		movMask = rank == 6 ? 0x80800000000000ui64 : 0x80000000000000ui64;
-		capMask = 0x140000000000000ui64;
 
 		movMask >>= 63 - pos;
 
@@ -340,13 +571,9 @@ uint64_t MoveGenerator::pawn(const piece_p pos, const color color, const uint64_
 
 		else if ((pieceMask & (posMask >> 16)))
 			movMask &= ~(posMask >> 16);
-
-		capMask >>= 63 - pos;
 	}
 
-	applyBorderMasks(capMask, posMask);
-	capMask &= otherColorMask;
-	movMask |= capMask;
+	movMask |= AttackTables::pawn(pos, color) & otherColorMask;
 
 	return movMask;
 }
@@ -354,258 +581,29 @@ uint64_t MoveGenerator::pawn(const piece_p pos, const color color, const uint64_
 
 uint64_t MoveGenerator::rook(const piece_p pos, const color color, const uint64_t pieceMask, const uint64_t colorMask)
 {
-	uint64_t movMask = 0;
-	uint64_t posMask = 1ui64 << pos;
-
-	// north
-	uint64_t checkMask = posMask << 8;
-
-	while (checkMask) {
-		if ((checkMask & pieceMask) == 0)
-			movMask |= checkMask;
-
-		else {
-			movMask |= checkMask & ~colorMask;
-			break;
-		}
-
-		checkMask <<= 8;
-	}
-
-	// south
-	checkMask = posMask >> 8;
-
-	while (checkMask != 0) {
-		if ((checkMask & pieceMask) == 0) {
-			movMask |= checkMask;
-		}
-		else {
-			movMask |= checkMask & ~colorMask;
-			break;
-		}
-
-		checkMask >>= 8;
-	}
-
-	// east
-	checkMask = posMask;
-	int n = 7 - pos % 8;
-
-	for (int i = 0; i < n; i++) {
-		checkMask <<= 1;
-
-		if ((checkMask & pieceMask) == 0) {
-			movMask |= checkMask;
-		}
-		else {
-			movMask |= checkMask & ~colorMask;
-			break;
-		}
-	}
-
-	// west
-	checkMask = posMask;
-	n = pos % 8;
-
-	for (int i = 0; i < n; i++) {
-		checkMask >>= 1;
-
-		if ((checkMask & pieceMask) == 0) {
-			movMask |= checkMask;
-		}
-		else {
-			movMask |= checkMask & ~colorMask;
-			break;
-		}
-	}
-
-	return movMask;
-}
-
-// slower than rook()
-uint64_t MoveGenerator::rook2(const piece_p pos, const color color, const uint64_t pieceMask, const uint64_t colorMask)
-{
-	const uint64_t posMask = 1ui64 << pos;
-	uint64_t movMask = 0;
-	uint64_t dir;
-	int64_t col;
-
-	// north
-	dir = 0x101010101010101ui64 << pos;
-	dir <<= 8;
-	col = dir & pieceMask;
-	col ^= -col;
-	col &= dir;
-	dir &= ~col;
-	movMask |= dir;
-
-	// south
-	dir = 0x8080808080808080ui64 >> (63 - pos);
-	dir >>= 8;
-	uint64_t rev = pieceMask & dir;
-	reverseBits64(rev);
-	rev ^= -(int64_t)rev;
-	reverseBits64(rev);
-	dir &= ~rev;
-	movMask |= dir;
-
-	// east
-	dir = 0xFFui64 << (pos / 8) * 8;
-	dir &= (0xFFui64 << pos) << 1;
-	col = dir & pieceMask;
-	col ^= -col;
-	col &= dir;
-	dir &= ~col;
-	movMask |= dir;
-
-	// west
-	file f = (pos / 8) * 8;
-	dir = 0xFFui64 << f;
-	dir &= (0xFF00000000000000ui64 >> (63 - pos)) >> 1;
-	uint8_t f_slice = (uint8_t)((pieceMask & dir) >> f);
-	f_slice = bitReverseTable8[f_slice];
-	f_slice ^= -f_slice;
-	f_slice = bitReverseTable8[f_slice];
-	col = f_slice;
-	col <<= f;
-	dir &= ~col;
-	movMask |= dir;
-
-	movMask &= ~colorMask;
-
-	return movMask;
+	return SlidingAttacks::rook(pos, pieceMask) & ~colorMask;
 }
 
 
 uint64_t MoveGenerator::bishop(const piece_p pos, const color color, const uint64_t pieceMask, const uint64_t colorMask)
 {
-	uint64_t movMask = 0ui64;
-	uint64_t posMask = 1ui64 << pos;
-
-	// north-east
-	uint64_t checkMask = posMask;
-	int n = 7 - pos % 8;
-
-	for (int i = 0; i < n; i++)
-	{
-		checkMask <<= 9;
-
-		if (checkMask == 0)
-			break;
-
-		if ((checkMask & pieceMask) == 0)
-			movMask |= checkMask;
-
-		else
-		{
-			movMask |= checkMask & ~colorMask;
-			break;
-		}
-	}
-
-	// south-east
-	checkMask = posMask;
-
-	for (int i = 0; i < n; i++)
-	{
-		checkMask >>= 7;
-
-		if (checkMask == 0)
-			break;
-
-		if ((checkMask & pieceMask) == 0)
-			movMask |= checkMask;
-
-		else
-		{
-			movMask |= checkMask & ~colorMask;
-			break;
-		}
-	}
-
-	// north-west
-	checkMask = posMask;
-	n = pos % 8;
-
-	for (int i = 0; i < n; i++)
-	{
-		checkMask <<= 7;
-
-		if (checkMask == 0)
-			break;
-
-		if ((checkMask & pieceMask) == 0)
-			movMask |= checkMask;
-
-		else
-		{
-			movMask |= checkMask & ~colorMask;
-			break;
-		}
-	}
-
-	// south-west
-	checkMask = posMask;
-
-	for (int i = 0; i < n; i++)
-	{
-		checkMask >>= 9;
-
-		if (checkMask == 0)
-			break;
-
-		if ((checkMask & pieceMask) == 0)
-			movMask |= checkMask;
-
-		else
-		{
-			movMask |= checkMask & ~colorMask;
-			break;
-		}
-	}
-
-	return movMask;
+	return SlidingAttacks::bishop(pos, pieceMask) & ~colorMask;
 }
 
 
 uint64_t MoveGenerator::knight(const piece_p pos)
 {
-	return basemovement(0x442800000028440ui64, pos);
+	return AttackTables::KNIGHT[pos];
 }
 
 
 uint64_t MoveGenerator::queen(const piece_p pos, const color color, const uint64_t pieceMask, const uint64_t colorMask)
 {
-	return rook(pos, color, pieceMask, colorMask) | bishop(pos, color, pieceMask, colorMask);
+	return SlidingAttacks::queen(pos, pieceMask) & ~colorMask;
 }
 
 
 uint64_t MoveGenerator::king(const piece_p pos)
 {
-	return basemovement(0x8380000000000382ui64, pos);
-}
-
-
-uint64_t MoveGenerator::basemovement(const uint64_t base, const piece_p pos)
-{
-	uint64_t posMask = 1ui64 << pos;
-	uint64_t legalMovement = base;
-	uint64_t movementMask = ~(0ui64);
-
-	rotl64(legalMovement, pos);
-	applyBorderMasks(movementMask, posMask);
-	legalMovement &= movementMask;
-
-	return legalMovement;
-}
-
-
-void MoveGenerator::applyBorderMasks(uint64_t &mask, const uint64_t posMask)
-{
-	if (posMask & Board::WEST_BORDER)  mask &= Board::WEST;
-	if (posMask & Board::EAST_BORDER)  mask &= Board::EAST;
-	if (posMask & Board::NORTH_BORDER) mask &= Board::NORTH;
-	if (posMask & Board::SOUTH_BORDER) mask &= Board::SOUTH;
+	return AttackTables::KING[pos];
 }
-
-
@@ -5,12 +5,15 @@
 #include <queue>
 #include <stack>
 #include <thread>
-#include <mutex>
+#include <atomic>
+#include <chrono>
 #include <climits>
 #include <iostream>
-#include <thread>
 #include "Board.h"
 #include "Node.h"
+#include "TranspositionTable.h"
+#include "WorkStealingDeque.h"
+#include "NodeArena.h"
 
 namespace chessengine
 {
@@ -19,34 +22,54 @@ namespace chessengine
 	{
 
 	public:
-		MoveGenerator(const unsigned int n_threads, const unsigned int max_depth, const Board &board);
+
+		// Upper bound of the number of moves in a position.
+		static const unsigned int MAX_MOVES = MoveList::CAPACITY;
+
+		MoveGenerator(const unsigned int n_threads, const unsigned int max_depth, const Board &board, TranspositionTable &table);
 		~MoveGenerator();
 
-		Node *createTree(const color turnColor);
-		uint64_t pieceMovementMask(const piece_p pos, const piece_t type, const color color, const Board &board);
+		Node *createTree(const color turnColor);	// The tree is valid until the next call or the generator's destruction.
+		static uint64_t pieceMovementMask(const piece_p pos, const piece_t type, const color color, const Board &board);
+		static void generateMoves(const Board &board, const color turn, MoveList &moves);
+		static void generateCaptures(const Board &board, const color turn, MoveList &moves);
 
 		static uint64_t pawn(const piece_p, const color, const uint64_t pieceMask, const uint64_t otherColorMask);
 		static uint64_t rook(const piece_p, const color, const uint64_t pieceMask, const uint64_t colorMask);
-		static uint64_t rook2(const piece_p, const color, const uint64_t pieceMask, const uint64_t colorMask);
 		static uint64_t bishop(const piece_p, const color, const uint64_t pieceMask, const uint64_t colorMask);
 		static uint64_t knight(const piece_p);
 		static uint64_t queen(const piece_p, const color, const uint64_t pieceMask, const uint64_t colorMask);
 		static uint64_t king(const piece_p);
 
 	private:
-		static uint64_t basemovement(const uint64_t, const piece_p);
-		static void applyBorderMasks(uint64_t &, const uint64_t);
 		static void printstat(const unsigned int &, const clock_t &);
+		static short relativeScore(const short value, const color turn);
+		static void addPawnMoves(const piece_p pos, uint64_t destinations, const bool allPromotions, MoveList &moves);
+		static void generateLegal(const Board &board, const color turn, const bool capturesOnly, MoveList &moves);
+		static uint64_t pinnedPieces(const Board &board, const color turn, const piece_p king);
+		static void addEnPassant(const Board &board, const color turn, const piece_p king, const uint64_t checkers, MoveList &moves);
+		static void addCastling(const Board &board, const color color, MoveList &moves);
 
-		void processNode(Node *root);
-		void processNodeFull(Node *root);
-		void processNodeStart(Node *root);
-		std::thread *createThreadWorker(Node *root);
+		// Subtrees with less remaining depth are always expanded by the thread that reached them.
+		static const unsigned int MIN_SPLIT_DEPTH = 2;
+
+		void processNode(Node *root, Board &board, NodeArena &arena);
+		bool processNodeFull(Node *root, Board &board, NodeArena &arena, WorkStealingDeque *deque);
+		void processNodeStart(const unsigned int worker);
+		bool takeWork(const unsigned int worker, Node *&node);
+		std::thread *createThreadWorker(const unsigned int worker);
 
 		const unsigned int MAX_THREADS;
 		const unsigned int MAX_DEPTH;
 		const Board &baseBoard;
-		unsigned int activeThreads;
+		TranspositionTable &table;
+		NodeArena *arenas;							// Node storage, one per worker thread.
+
+		// Work stealing state of a multithreaded tree generation.
+		WorkStealingDeque *deques;					// One per worker thread.
+		std::atomic<unsigned int> pendingTasks;		// Subtrees queued or being expanded.
+		std::atomic<unsigned int> queuedTasks;		// Subtrees queued in any deque.
+		std::atomic<unsigned int> idleThreads;		// Workers without a subtree.
 
 	};
 
@@ -0,0 +1,125 @@
+#include <cstdlib>
+#include "MoveOrdering.h"
+
+using namespace chessengine;
+
+const int MoveOrdering::VICTIM_VALUE[6] = { 1, 5, 3, 3, 9, 0 };
+const int MoveOrdering::ATTACKER_VALUE[6] = { 1, 5, 3, 3, 9, 20 };
+
+MoveOrdering::MoveOrdering()
+{
+	clear();
+}
+
+
+void MoveOrdering::clear()
+{
+	const Move none = Move::none();
+
+	for (int ply = 0; ply < MAX_PLY; ply++)
+	{
+		killers[ply][0] = none;
+		killers[ply][1] = none;
+	}
+
+	for (int c = 0; c < 2; c++)
+		for (int from = 0; from < 64; from++)
+			for (int to = 0; to < 64; to++)
+				history[c][from][to] = 0;
+
+	for (int piece = 0; piece < 12; piece++)
+		for (int pos = 0; pos < 64; pos++)
+			counterMoves[piece][pos] = none;
+}
+
+// True if the move neither captures nor promotes.
+bool MoveOrdering::isQuiet(const Board &board, const Move &move)
+{
+	return board.pieceAt(move.dest()) == Board::EMPTY && (move.kind() == Move::NORMAL || move.kind() == Move::CASTLING);
+}
+
+// Assigns ordering scores to all moves of the list.
+void MoveOrdering::score(const Board &board, const color turn, ScoredMoveList &list, const uint16_t hashMove, const int ply, const Move &previous) const
+{
+	const Move none = Move::none();
+	const int8_t previousPiece = previous == none ? Board::EMPTY : board.pieceAt(previous.dest());
+	const Move &counter = previousPiece == Board::EMPTY ? none : counterMoves[previousPiece][previous.dest()];
+	const int (&colorHistory)[64][64] = history[turn / Board::BLACK];
+
+	for (unsigned int i = 0; i < list.size; i++)
+	{
+		const Move &move = list.moves[i];
+		const int8_t victim = move.kind() == Move::EN_PASSANT ? Board::PAWN : board.pieceAt(move.dest());
+		const piece_t attacker = board.pieceType(move.pos());
+
+		if (move.pack() == hashMove)
+		{
+			list.scores[i] = HASH_MOVE_SCORE;
+		}
+		else if (victim != Board::EMPTY)
+		{
+			// most valuable victim, least valuable attacker
+			list.scores[i] = CAPTURE_SCORE + VICTIM_VALUE[victim % Board::BLACK] * 32 - ATTACKER_VALUE[attacker];
+		}
+		else if (move.kind() == Move::PROMOTION)
+		{
+			// promotions rank like capturing the promoted piece, underpromotions after the quiet moves
+			list.scores[i] = move.promotion() == Board::QUEEN
+				? CAPTURE_SCORE + VICTIM_VALUE[Board::QUEEN] * 32 - ATTACKER_VALUE[Board::PAWN]
+				: -HISTORY_MAX - VICTIM_VALUE[Board::QUEEN] + VICTIM_VALUE[move.promotion()];
+		}
+		else if (move == killers[ply][0])
+		{
+			list.scores[i] = KILLER_SCORE;
+		}
+		else if (move == killers[ply][1])
+		{
+			list.scores[i] = KILLER_SCORE - 1;
+		}
+		else if (move == counter)
+		{
+			list.scores[i] = COUNTERMOVE_SCORE;
+		}
+		else
+		{
+			list.scores[i] = colorHistory[move.pos()][move.dest()];
+		}
+	}
+}
+
+// Rewards a quiet move that caused a beta cutoff and penalizes the quiet moves searched before it.
+// Must be called before the move is made, previous is the move that led to the position.
+void MoveOrdering::update(const Board &board, const color turn, const Move &best, const Move *quiets, const unsigned int quietCount, const int depth, const int ply, const Move &previous)
+{
+	// Scaled by 32 in updateHistory, the largest bonus moves an entry all the way to the bound and no further.
+	const int bonus = depth * depth < HISTORY_MAX / 32 ? depth * depth : HISTORY_MAX / 32;
+	int (&colorHistory)[64][64] = history[turn / Board::BLACK];
+
+	if (killers[ply][0] != best)
+	{
+		killers[ply][1] = killers[ply][0];
+		killers[ply][0] = best;
+	}
+
+	updateHistory(colorHistory[best.pos()][best.dest()], bonus);
+
+	for (unsigned int i = 0; i < quietCount; i++)
+	{
+		if (quiets[i] != best)
+			updateHistory(colorHistory[quiets[i].pos()][quiets[i].dest()], -bonus);
+	}
+
+	if (previous != Move::none())
+	{
+		const int8_t previousPiece = board.pieceAt(previous.dest());
+		if (previousPiece != Board::EMPTY)
+			counterMoves[previousPiece][previous.dest()] = best;
+	}
+}
+
+// Applies a bonus with gravity towards zero. For bonuses up to HISTORY_MAX / 32 this keeps the entry within
+// [-HISTORY_MAX, HISTORY_MAX].
+void MoveOrdering::updateHistory(int &entry, const int bonus)
+{
+	entry += bonus * 32 - entry * std::abs(bonus) * 32 / HISTORY_MAX;
+}
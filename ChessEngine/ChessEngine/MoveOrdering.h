@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include "Board.h"
+#include "MoveGenerator.h"
+
+namespace chessengine
+{
+
+	// Moves of a position with their ordering scores.
+	struct ScoredMoveList : MoveList
+	{
+		int scores[MoveList::CAPACITY];
+
+		// Swaps the highest scored of the remaining moves to index and returns it.
+		inline const Move &pick(const unsigned int index)
+		{
+			unsigned int best = index;
+			for (unsigned int i = index + 1; i < size; i++)
+			{
+				if (scores[i] > scores[best])
+					best = i;
+			}
+
+			if (best != index)
+			{
+				const Move move = moves[index];
+				const int score = scores[index];
+				moves[index] = moves[best];
+				scores[index] = scores[best];
+				moves[best] = move;
+				scores[best] = score;
+			}
+
+			return moves[index];
+		}
+	};
+
+	// Move ordering heuristics of a search: hash move first, then captures by MVV-LVA, killer moves,
+	// the countermove, and the remaining quiet moves by their history score.
+	class MoveOrdering
+	{
+
+	public:
+
+		static const int MAX_PLY = 64;
+
+		// Score of each move class. History scores stay within [-HISTORY_MAX, HISTORY_MAX].
+
+		static const int HASH_MOVE_SCORE = 1000000;
+		static const int CAPTURE_SCORE = 100000;
+		static const int KILLER_SCORE = 90000;
+		static const int COUNTERMOVE_SCORE = 80000;
+		static const int HISTORY_MAX = 16384;
+
+		MoveOrdering();
+
+		void clear();
+		void score(const Board &board, const color turn, ScoredMoveList &list, const uint16_t hashMove, const int ply, const Move &previous) const;
+		void update(const Board &board, const color turn, const Move &best, const Move *quiets, const unsigned int quietCount, const int depth, const int ply, const Move &previous);
+		static bool isQuiet(const Board &board, const Move &move);
+
+	private:
+
+		// Ordering values of the piece types for MVV-LVA, the king is the least attractive attacker.
+		static const int VICTIM_VALUE[6];
+		static const int ATTACKER_VALUE[6];
+
+		Move killers[MAX_PLY][2];		// Quiet moves that caused a cutoff at the same ply.
+		int history[2][64][64];			// Butterfly history, indexed by color / BLACK, origin and destination.
+		Move counterMoves[12][64];		// Refutation of the previous move, indexed by its piece and destination.
+
+		static void updateHistory(int &entry, const int bonus);
+	};
+
+}
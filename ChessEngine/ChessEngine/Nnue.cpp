@@ -0,0 +1,261 @@
+#include "Nnue.h"
+#include "NnueAvx2.h"
+#include "Bitops.h"
+#include <cstring>
+
+// Vector kernels: 256-bit in NnueAvx2 when the CPU supports AVX2, otherwise 128-bit, which only needs SSE2 and so
+// runs on every x64 CPU. Other architectures use the scalar kernels.
+#if defined(NNUE_SIMD)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+using namespace chessengine;
+
+// Input order of the piece types in the network file, indexed by the piece type of the board.
+static const unsigned int INPUT_TYPE[6] = { 0, 3, 1, 2, 4, 5 };
+
+MappedFile Nnue::file;
+const int16_t *Nnue::featureWeights = nullptr;
+const int16_t *Nnue::featureBias = nullptr;
+const int16_t *Nnue::outputWeights = nullptr;
+int32_t Nnue::outputBias = 0;
+bool Nnue::enabled = true;
+bool Nnue::avx2 = false;
+
+// Sets dst to src plus the added rows minus the removed rows, each row HIDDEN values long.
+static void applyRows(int16_t *dst, const int16_t *src, const int16_t *const *added, const unsigned int addedCount,
+	const int16_t *const *removed, const unsigned int removedCount)
+{
+#if defined(NNUE_SIMD)
+	if (Nnue::usesAvx2())
+	{
+		NnueAvx2::applyRows(dst, src, added, addedCount, removed, removedCount);
+		return;
+	}
+
+	for (unsigned int i = 0; i < Nnue::HIDDEN; i += 8)
+	{
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+		for (unsigned int r = 0; r < addedCount; r++)
+			v = _mm_add_epi16(v, _mm_loadu_si128(reinterpret_cast<const __m128i *>(added[r] + i)));
+		for (unsigned int r = 0; r < removedCount; r++)
+			v = _mm_sub_epi16(v, _mm_loadu_si128(reinterpret_cast<const __m128i *>(removed[r] + i)));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), v);
+	}
+#else
+	for (unsigned int i = 0; i < Nnue::HIDDEN; i++)
+	{
+		int16_t v = src[i];
+		for (unsigned int r = 0; r < addedCount; r++)
+			v += added[r][i];
+		for (unsigned int r = 0; r < removedCount; r++)
+			v -= removed[r][i];
+		dst[i] = v;
+	}
+#endif
+}
+
+// Dot product of the clipped ReLU activation of the hidden values, clamp(v, 0, QA), with the output weights.
+static int32_t activatedDot(const int16_t *values, const int16_t *weights)
+{
+#if defined(NNUE_SIMD)
+	if (Nnue::usesAvx2())
+		return NnueAvx2::activatedDot(values, weights);
+
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i qa = _mm_set1_epi16(Nnue::QA);
+	__m128i sum = _mm_setzero_si128();
+
+	for (unsigned int i = 0; i < Nnue::HIDDEN; i += 8)
+	{
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+		v = _mm_min_epi16(_mm_max_epi16(v, zero), qa);
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(v, _mm_loadu_si128(reinterpret_cast<const __m128i *>(weights + i))));
+	}
+
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum);
+#else
+	int32_t sum = 0;
+	for (unsigned int i = 0; i < Nnue::HIDDEN; i++)
+	{
+		const int32_t v = values[i] < 0 ? 0 : values[i] > Nnue::QA ? Nnue::QA : values[i];
+		sum += v * weights[i];
+	}
+	return sum;
+#endif
+}
+
+// Selects the vector kernels for the CPU. Must be called once at startup.
+void Nnue::init()
+{
+	avx2 = detectAvx2();
+}
+
+
+bool Nnue::usesAvx2()
+{
+	return avx2;
+}
+
+// True if the CPU supports AVX2 and the operating system saves the 256-bit registers on context switches.
+// Other compilers than MSVC only accept _xgetbv in code compiled for XSAVE, which the check itself ensures.
+#if defined(__GNUC__)
+__attribute__((target("xsave")))
+#endif
+bool Nnue::detectAvx2()
+{
+#if defined(NNUE_SIMD)
+	int regs[4];
+
+	__cpuidex(regs, 0, 0);
+	if (regs[0] < 7)
+		return false;
+
+	__cpuidex(regs, 1, 0);
+	const bool osxsave = (regs[2] & (1 << 27)) != 0;
+	const bool avx = (regs[2] & (1 << 28)) != 0;
+	if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+		return false;
+
+	__cpuidex(regs, 7, 0);
+	return (regs[1] & (1 << 5)) != 0;
+#else
+	return false;
+#endif
+}
+
+// Maps a network file and uses it in place of the current network. Returns false, keeping the current network,
+// if the file cannot be mapped or does not match the network size.
+bool Nnue::load(const std::string &path)
+{
+	static const size_t WEIGHTS_SIZE = sizeof(int16_t) * (INPUTS * HIDDEN + HIDDEN + 2 * HIDDEN);
+
+	MappedFile candidate;
+	if (!candidate.open(path) || candidate.size() != sizeof(Header) + WEIGHTS_SIZE + sizeof(int32_t))
+		return false;
+
+	Header header;
+	std::memcpy(&header, candidate.data(), sizeof(Header));
+	if (std::memcmp(header.magic, "BNUE", 4) != 0 || header.version != VERSION || header.inputs != INPUTS || header.hidden != HIDDEN)
+		return false;
+
+	unload();
+	file.swap(candidate);
+
+	featureWeights = reinterpret_cast<const int16_t *>(file.data() + sizeof(Header));
+	featureBias = featureWeights + INPUTS * HIDDEN;
+	outputWeights = featureBias + HIDDEN;
+	std::memcpy(&outputBias, file.data() + sizeof(Header) + WEIGHTS_SIZE, sizeof(int32_t));
+
+	return true;
+}
+
+
+void Nnue::unload()
+{
+	file.close();
+	featureWeights = nullptr;
+	featureBias = nullptr;
+	outputWeights = nullptr;
+	outputBias = 0;
+}
+
+// Selects the network or the handcrafted evaluation for searches started afterwards.
+void Nnue::setEnabled(const bool enabled)
+{
+	Nnue::enabled = enabled;
+}
+
+// True if searches evaluate with the network: it is enabled and a network is loaded.
+bool Nnue::active()
+{
+	return enabled && featureWeights != nullptr;
+}
+
+
+inline const int16_t *Nnue::featureRow(const int8_t piece, const piece_p pos, const color perspective)
+{
+	const color pieceColor = piece < Board::BLACK ? Board::WHITE : Board::BLACK;
+	const unsigned int relative = pieceColor == perspective ? 0 : 384;
+	const piece_p square = perspective == Board::WHITE ? pos : pos ^ 56;
+
+	return featureWeights + (relative + INPUT_TYPE[piece % Board::BLACK] * 64 + square) * HIDDEN;
+}
+
+// Computes the accumulator of a position from scratch.
+void Nnue::refresh(const Board &board, Accumulator &accumulator)
+{
+	for (color perspective = Board::WHITE; perspective <= Board::BLACK; perspective += Board::BLACK)
+	{
+		const int16_t *rows[64];
+		unsigned int count = 0;
+		uint64_t occupied = board.positionMask();
+
+		while (occupied)
+		{
+			const piece_p pos = popLSB(occupied);
+			rows[count++] = featureRow(board.pieceAt(pos), pos, perspective);
+		}
+
+		applyRows(accumulator.values[perspective / Board::BLACK], featureBias, rows, count, nullptr, 0);
+	}
+}
+
+// Computes the accumulator after the last move made on the board from the accumulator before it.
+void Nnue::update(const Board &board, const Accumulator &parent, Accumulator &accumulator)
+{
+	const Undo &undo = board.lastMove();
+	const piece_p pos = undo.move.pos();
+	const piece_p dest = undo.move.dest();
+	const color moverColor = undo.piece < Board::BLACK ? Board::WHITE : Board::BLACK;
+
+	// At most two pieces are added and two removed: the moved piece, a captured piece and the castling rook.
+	int8_t addedPiece[2], removedPiece[2];
+	piece_p addedPos[2], removedPos[2];
+	unsigned int addedCount = 0, removedCount = 0;
+
+	removedPiece[removedCount] = undo.piece;
+	removedPos[removedCount++] = pos;
+	addedPiece[addedCount] = undo.move.kind() == Move::PROMOTION ? moverColor + undo.move.promotion() : undo.piece;
+	addedPos[addedCount++] = dest;
+
+	if (undo.captured != Board::EMPTY)
+	{
+		removedPiece[removedCount] = undo.captured;
+		removedPos[removedCount++] = undo.move.kind() != Move::EN_PASSANT ? dest : moverColor == Board::WHITE ? dest - 8 : dest + 8;
+	}
+	else if (undo.move.kind() == Move::CASTLING)
+	{
+		removedPiece[removedCount] = moverColor + Board::ROOK;
+		removedPos[removedCount++] = dest > pos ? pos + 3 : pos - 4;
+		addedPiece[addedCount] = moverColor + Board::ROOK;
+		addedPos[addedCount++] = dest > pos ? pos + 1 : pos - 1;
+	}
+
+	for (color perspective = Board::WHITE; perspective <= Board::BLACK; perspective += Board::BLACK)
+	{
+		const int16_t *added[2], *removed[2];
+
+		for (unsigned int i = 0; i < addedCount; i++)
+			added[i] = featureRow(addedPiece[i], addedPos[i], perspective);
+		for (unsigned int i = 0; i < removedCount; i++)
+			removed[i] = featureRow(removedPiece[i], removedPos[i], perspective);
+
+		const unsigned int index = perspective / Board::BLACK;
+		applyRows(accumulator.values[index], parent.values[index], added, addedCount, removed, removedCount);
+	}
+}
+
+// Score of the position in centipawns, relative to the side to move.
+int Nnue::evaluate(const Accumulator &accumulator, const color turn)
+{
+	const unsigned int us = turn / Board::BLACK;
+	const int32_t output = activatedDot(accumulator.values[us], outputWeights)
+		+ activatedDot(accumulator.values[us ^ 1], outputWeights + HIDDEN)
+		+ outputBias;
+
+	return (int)((int64_t)output * SCALE / (QA * QB));
+}
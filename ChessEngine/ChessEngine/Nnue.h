@@ -0,0 +1,83 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "Board.h"
+#include "MappedFile.h"
+
+namespace chessengine
+{
+
+	// Efficiently updatable neural network evaluation, an alternative to the handcrafted Validator.
+	// Each perspective has a hidden layer of HIDDEN clipped ReLU neurons fed by 768 piece-square inputs (piece type,
+	// piece color relative to the perspective, and the square, mirrored vertically for black). The neurons of both
+	// perspectives, side to move first, feed a single output. The hidden layer values before activation form the
+	// accumulator. A move changes only a few inputs, so the accumulator of a position is computed from the one of
+	// the previous position by adding and subtracting a few weight rows.
+	//
+	// The network is memory mapped and used in place. File layout, little endian:
+	//   header: "BNUE", version (uint32), INPUTS (uint32), HIDDEN (uint32), 16 reserved bytes
+	//   int16 feature weights [INPUTS][HIDDEN], scaled by QA, inputs ordered pawn, knight, bishop, rook, queen, king
+	//   int16 feature biases [HIDDEN], scaled by QA
+	//   int16 output weights [2][HIDDEN], scaled by QB, side to move first
+	//   int32 output bias, scaled by QA * QB
+	class Nnue
+	{
+
+	public:
+
+		// Network size
+
+		static const unsigned int INPUTS = 768;
+		static const unsigned int HIDDEN = 256;
+		static const uint32_t VERSION = 1;
+
+		// Quantisation of the weights, and the scale of the output to centipawns.
+
+		static const int QA = 255;
+		static const int QB = 64;
+		static const int SCALE = 400;
+
+		// Hidden layer values of both perspectives, indexed by color / Board::BLACK.
+		struct Accumulator
+		{
+			int16_t values[2][HIDDEN];
+		};
+
+		static void init();
+		static bool usesAvx2();
+		static bool load(const std::string &path);
+		static void unload();
+		static void setEnabled(const bool enabled);
+		static bool active();
+
+		static void refresh(const Board &board, Accumulator &accumulator);
+		static void update(const Board &board, const Accumulator &parent, Accumulator &accumulator);
+		static int evaluate(const Accumulator &accumulator, const color turn);
+
+	private:
+
+		struct Header
+		{
+			char magic[4];
+			uint32_t version;
+			uint32_t inputs;
+			uint32_t hidden;
+			uint8_t reserved[16];
+		};
+
+		static MappedFile file;
+		static const int16_t *featureWeights;
+		static const int16_t *featureBias;
+		static const int16_t *outputWeights;
+		static int32_t outputBias;
+		static bool enabled;
+		static bool avx2;			// The AVX2 kernels are used, the CPU supports them.
+
+		static bool detectAvx2();
+
+		// Weight row of a piece (color + type) on a square, seen from a perspective.
+		static inline const int16_t *featureRow(const int8_t piece, const piece_p pos, const color perspective);
+
+	};
+
+}
@@ -0,0 +1,49 @@
+#include "NnueAvx2.h"
+#include "Nnue.h"
+
+#if defined(NNUE_SIMD)
+
+// MSVC compiles this file with /arch:AVX2, other compilers enable AVX2 here.
+#if defined(__GNUC__) && !defined(__AVX2__)
+#pragma GCC target("avx2")
+#endif
+#include <immintrin.h>
+
+using namespace chessengine;
+
+// Sets dst to src plus the added rows minus the removed rows, each row HIDDEN values long.
+void NnueAvx2::applyRows(int16_t *dst, const int16_t *src, const int16_t *const *added, const unsigned int addedCount,
+	const int16_t *const *removed, const unsigned int removedCount)
+{
+	for (unsigned int i = 0; i < Nnue::HIDDEN; i += 16)
+	{
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+		for (unsigned int r = 0; r < addedCount; r++)
+			v = _mm256_add_epi16(v, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(added[r] + i)));
+		for (unsigned int r = 0; r < removedCount; r++)
+			v = _mm256_sub_epi16(v, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(removed[r] + i)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), v);
+	}
+}
+
+// Dot product of the clipped ReLU activation of the hidden values, clamp(v, 0, QA), with the output weights.
+int32_t NnueAvx2::activatedDot(const int16_t *values, const int16_t *weights)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i qa = _mm256_set1_epi16(Nnue::QA);
+	__m256i sum = _mm256_setzero_si256();
+
+	for (unsigned int i = 0; i < Nnue::HIDDEN; i += 16)
+	{
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+		v = _mm256_min_epi16(_mm256_max_epi16(v, zero), qa);
+		sum = _mm256_add_epi32(sum, _mm256_madd_epi16(v, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weights + i))));
+	}
+
+	__m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+	half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+	half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(half);
+}
+
+#endif
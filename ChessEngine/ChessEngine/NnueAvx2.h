@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+
+// The vector kernels need an x86 CPU with at least SSE2, as every x64 CPU has.
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define NNUE_SIMD
+#endif
+
+namespace chessengine
+{
+
+	// AVX2 kernels of the network evaluation.
+	// This file alone is compiled with AVX2 enabled, so the rest of the engine runs on any x64 CPU. Nnue only
+	// calls these kernels after checking at startup that the CPU supports AVX2.
+	class NnueAvx2
+	{
+
+	public:
+
+		static void applyRows(int16_t *dst, const int16_t *src, const int16_t *const *added, const unsigned int addedCount,
+			const int16_t *const *removed, const unsigned int removedCount);
+		static int32_t activatedDot(const int16_t *values, const int16_t *weights);
+
+	};
+
+}
@@ -10,23 +10,18 @@ Node::Node()
 
 Node::~Node()
 {
-	for (size_t i = 0; i < fields.num_childs; i++)
-	{
-		delete childrenPtr[i];
-		childrenPtr[i] = nullptr;
-	}
-	delete[] childrenPtr;
-	childrenPtr = nullptr;
 }
 
-
-void Node::addChild(Node *node)
+// Sets the children of the node. The children are owned by the arena they were allocated from.
+void Node::setChildren(Node *children, const unsigned int count)
 {
-	if (fields.num_childs == max_childs)
-		extendChildrenTable();
+	childrenPtr = children;
+	fields.num_childs = count;
 
-	childrenPtr[fields.num_childs++] = node;
-	node->parentPtr = this;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		children[i].parentPtr = this;
+	}
 }
 
 
@@ -52,7 +47,7 @@ uint64_t Node::size() const
 	uint64_t n = 1;
 	for (size_t i = 0; i < fields.num_childs; i++)
 	{
-		n += childrenPtr[i]->size();
+		n += childrenPtr[i].size();
 	}
 	return n;
 }
@@ -63,14 +58,14 @@ std::vector<Node*> Node::getBestChildren() const
 	std::vector<Node*> vec;
 	for (size_t i = 0; i < fields.num_childs; i++)
 	{
-		if (childrenPtr[i]->value == value)
-			vec.push_back(childrenPtr[i]);
+		if (childrenPtr[i].value == value)
+			vec.push_back(&childrenPtr[i]);
 	}
 	return vec;
 }
 
 
-void Node::validate()
+void Node::validate(const Board &board)
 {
 	if (fields.validated == 0) {
 		fields.validated = 1;
@@ -81,7 +76,7 @@ void Node::validate()
 
 void Node::performAllStoredMoves(Board &board)
 {
-	Node **parentsPtr = new Node*[fields.depth];
+	Node *parentsPtr[32];	// depth is a 5 bit field
 	Node *nPtr = this;
 
 	unsigned int c = 0;
@@ -95,28 +90,11 @@ void Node::performAllStoredMoves(Board &board)
 	{
 		parentsPtr[i]->performStoredMove(board);
 	}
-
-	delete[] parentsPtr;
 }
 
 
 void Node::performStoredMove(Board &board)
 {
-	board.movePiece(fields.position, fields.piece_t, parentPtr->getColor(), fields.destination);
+	board.makeMove(move, parentPtr->getColor());
 }
 
-
-void Node::extendChildrenTable()
-{
-	unsigned int new_size = max_childs == 0 ? max_childs = 8 : max_childs *= 2;
-
-	Node **tmpPtr = new Node*[new_size];
-
-	for (size_t i = 0; i < fields.num_childs; i++)
-	{
-		tmpPtr[i] = childrenPtr[i];
-	}
-
-	delete[] childrenPtr;
-	childrenPtr = tmpPtr;
-}
@@ -9,14 +9,11 @@ typedef uint8_t field;
 
 struct Fields
 {
-	uint32_t depth : 5;       // 0..31
-	uint32_t color : 1;       // 0..1
-	uint32_t position : 6;    // 0..63
-	uint32_t piece_t : 3;     // 0..5
-	uint32_t destination : 6; // 0..63
-	uint32_t num_childs : 6;  // 0..63
-	uint32_t validated : 1;   // 0..1
-	uint32_t kingcheck : 1;   // 0..1
+	uint16_t depth : 5;       // 0..31
+	uint16_t color : 1;       // 0..1
+	uint16_t num_childs : 8;  // 0..255
+	uint16_t validated : 1;   // 0..1
+	uint16_t kingcheck : 1;   // 0..1
 };
 
 class Node
@@ -24,26 +21,23 @@ class Node
 
 public:
 	short value = 0;
-	Fields fields = {0, 0, 0, 0, 0, 0, 0, 0};
+	Fields fields = {0, 0, 0, 0, 0};
+	Move move = Move::none();		// The move leading to the node.
 	Node *parentPtr = nullptr;
-	Node **childrenPtr = nullptr;
-	Board board;
+	Node *childrenPtr = nullptr;	// Contiguous table of the children, allocated from a NodeArena.
 	
 	Node();
 	~Node();
 
-	void addChild(Node *node);
+	void setChildren(Node *children, const unsigned int count);
 	color getColor() const;
 	void setColor(const color color);
 	void performAllStoredMoves(Board &board);
 	uint64_t size() const;
 	std::vector<Node*> getBestChildren() const;
-	void validate();
+	void validate(const Board &board);
 
 private:
-	uint8_t max_childs = 0;
-
-	void extendChildrenTable();
 	void performStoredMove(Board &board);
 
 };
\ No newline at end of file
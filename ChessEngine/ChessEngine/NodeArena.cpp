@@ -0,0 +1,62 @@
+#include <new>
+#include "NodeArena.h"
+
+using namespace chessengine;
+
+NodeArena::NodeArena()
+	: block(0), used(0)
+{
+	blocks.push_back(static_cast<Node*>(::operator new(BLOCK_SIZE * sizeof(Node))));
+}
+
+
+NodeArena::~NodeArena()
+{
+	for (Node *b : blocks)
+	{
+		::operator delete(b);
+	}
+}
+
+// Allocates count default constructed nodes, contiguous in memory. count must not exceed BLOCK_SIZE.
+Node *NodeArena::allocate(const unsigned int count)
+{
+	if (used + count > BLOCK_SIZE)
+	{
+		block++;
+		used = 0;
+
+		if (block == blocks.size())
+			blocks.push_back(static_cast<Node*>(::operator new(BLOCK_SIZE * sizeof(Node))));
+	}
+
+	Node *nodes = blocks[block] + used;
+	used += count;
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		new (&nodes[i]) Node();
+	}
+
+	return nodes;
+}
+
+
+NodeArena::Mark NodeArena::mark() const
+{
+	return { block, used };
+}
+
+// Releases all nodes allocated after the mark was taken.
+void NodeArena::rewind(const Mark &mark)
+{
+	block = mark.block;
+	used = mark.used;
+}
+
+// Releases all nodes.
+void NodeArena::reset()
+{
+	block = 0;
+	used = 0;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "Node.h"
+
+namespace chessengine
+{
+
+	// Bump-pointer allocator of tree nodes, owned by one thread.
+	// Nodes are never freed one by one. Since a thread expands its subtrees depth first, a collapsed subtree
+	// is always the most recent allocation and is released by rewinding to a mark taken before it was
+	// allocated. The whole arena is reset between searches, and its blocks are kept for reuse.
+	class NodeArena
+	{
+
+	public:
+
+		static const unsigned int BLOCK_SIZE = 1 << 14;	// Nodes per block.
+
+		// Allocation position of the arena.
+		struct Mark
+		{
+			size_t block;
+			unsigned int used;
+		};
+
+		NodeArena();
+		~NodeArena();
+
+		Node *allocate(const unsigned int count);
+		Mark mark() const;
+		void rewind(const Mark &mark);
+		void reset();
+
+	private:
+
+		std::vector<Node*> blocks;
+		size_t block;		// Index of the block allocated from.
+		unsigned int used;	// Nodes allocated from the current block.
+
+		NodeArena(const NodeArena&) = delete;
+		NodeArena &operator=(const NodeArena&) = delete;
+
+	};
+
+}
@@ -0,0 +1,70 @@
+#include "ParallelSearch.h"
+#include <thread>
+
+using namespace chessengine;
+
+// Needs a pawn table for each thread.
+ParallelSearch::ParallelSearch(const Board &board, const color turn, TranspositionTable &table, const std::vector<PawnTable*> &pawnTables, const unsigned int threads)
+	: stopHelpers(false)
+{
+	for (unsigned int i = 0; i < (threads > 0 ? threads : 1); i++)
+	{
+		searches.push_back(new Search(board, turn, table, *pawnTables[i], i));
+	}
+	searches[0]->setThreads(searches);
+}
+
+
+ParallelSearch::~ParallelSearch()
+{
+	for (Search *search : searches)
+	{
+		delete search;
+	}
+}
+
+// Runs the main search on the calling thread and the helpers on their own threads. The helpers are stopped
+// as soon as the main search has finished, and the score of the main search is returned.
+short ParallelSearch::run(const SearchLimits &limits, const std::atomic<bool> &stop, const std::atomic<bool> *ponder)
+{
+	std::vector<std::thread> helpers;
+	stopHelpers = false;
+
+	for (size_t i = 1; i < searches.size(); i++)
+	{
+		helpers.emplace_back([this, i, &limits]() { searches[i]->run(limits, stopHelpers); });
+	}
+
+	const short score = searches[0]->run(limits, stop, ponder);
+
+	stopHelpers = true;
+	for (std::thread &helper : helpers)
+	{
+		helper.join();
+	}
+
+	return score;
+}
+
+
+const Search &ParallelSearch::mainSearch() const
+{
+	return *searches[0];
+}
+
+// Nodes searched by all threads.
+uint64_t ParallelSearch::nodeCount() const
+{
+	uint64_t nodes = 0;
+	for (const Search *search : searches)
+	{
+		nodes += search->nodeCount();
+	}
+	return nodes;
+}
+
+// Makes the main search print UCI info lines, with the counters of all threads.
+void ParallelSearch::reportTo(std::ostream &out)
+{
+	searches[0]->reportTo(out);
+}
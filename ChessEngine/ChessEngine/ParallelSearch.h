@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <atomic>
+#include "Board.h"
+#include "Search.h"
+#include "TranspositionTable.h"
+#include "PawnTable.h"
+#include "TimeManager.h"
+
+namespace chessengine
+{
+
+	// Lazy SMP search: the main search and a number of helper searches run the same root position in parallel,
+	// each on its own board. They only communicate through the shared transposition table, where the helpers'
+	// results steer the move ordering and cutoffs of the main search. Helpers search staggered depths, so they
+	// fill the table with different parts of the tree. Each thread evaluates with its own pawn table, which the caller
+	// keeps across searches.
+	class ParallelSearch
+	{
+
+	public:
+
+		ParallelSearch(const Board &board, const color turn, TranspositionTable &table, const std::vector<PawnTable*> &pawnTables, const unsigned int threads);
+		~ParallelSearch();
+
+		short run(const SearchLimits &limits, const std::atomic<bool> &stop, const std::atomic<bool> *ponder = nullptr);
+		const Search &mainSearch() const;
+		uint64_t nodeCount() const;
+		void reportTo(std::ostream &out);
+
+	private:
+
+		std::vector<Search*> searches;	// The main search first, followed by the helpers.
+		std::atomic<bool> stopHelpers;
+
+	};
+
+}
@@ -0,0 +1,142 @@
+#include "PawnTable.h"
+#include "AttackTables.h"
+#include "Bitops.h"
+#include <intrin.h>
+
+using namespace chessengine;
+
+const short PawnTable::PASSED_MIDGAME[8] = { 0, 5, 10, 15, 30, 55, 90, 0 };
+const short PawnTable::PASSED_ENDGAME[8] = { 0, 10, 15, 25, 45, 80, 130, 0 };
+
+static const uint64_t A_FILE_MASK = 0x0101010101010101ui64;
+
+PawnTable::PawnTable()
+	: entries(new Entry[SIZE])
+{
+	clear();
+}
+
+
+PawnTable::~PawnTable()
+{
+	delete[] entries;
+}
+
+// Empties the table. A cleared entry holds the zero scores and masks of a position without pawns, whose pawn key
+// is 0, so it is valid as it is.
+void PawnTable::clear()
+{
+	for (unsigned int i = 0; i < SIZE; i++)
+	{
+		entries[i] = Entry();
+		entries[i].kingSquare[0] = Board::NO_SQUARE;
+		entries[i].kingSquare[1] = Board::NO_SQUARE;
+	}
+}
+
+// Entry of the pawn structure of the board, evaluated first if it is not in the table.
+PawnTable::Entry &PawnTable::probe(const Board &board)
+{
+	const uint64_t key = board.pawnHash();
+	Entry &entry = entries[key & (SIZE - 1)];
+
+	if (entry.key != key)
+	{
+		evaluate(board, entry);
+	}
+
+	return entry;
+}
+
+// Evaluates the pawn structure of the board into an entry: doubled, isolated and passed pawns, and the masks of
+// passed pawns and pawn attacks.
+void PawnTable::evaluate(const Board &board, Entry &entry)
+{
+	entry.key = board.pawnHash();
+	entry.midgame = 0;
+	entry.endgame = 0;
+	entry.kingSquare[0] = Board::NO_SQUARE;
+	entry.kingSquare[1] = Board::NO_SQUARE;
+
+	for (color side = Board::WHITE; side <= Board::BLACK; side += Board::BLACK)
+	{
+		const unsigned int index = side / Board::BLACK;
+		const unsigned int forward = side == Board::WHITE ? AttackTables::NORTH : AttackTables::SOUTH;
+		const uint64_t own = board.bitboard[side + Board::PAWN];
+		const uint64_t enemy = board.bitboard[(side ^ Board::BLACK) + Board::PAWN];
+		const short sign = side == Board::WHITE ? 1 : -1;
+
+		entry.passed[index] = 0;
+		entry.attacks[index] = 0;
+
+		uint64_t pawns = own;
+		while (pawns)
+		{
+			const piece_p pos = popLSB(pawns);
+			const file f = pos % 8;
+			const uint64_t westFront = f > Board::A_FILE ? AttackTables::RAY[forward][pos - 1] : 0;
+			const uint64_t eastFront = f < Board::H_FILE ? AttackTables::RAY[forward][pos + 1] : 0;
+			const uint64_t neighbourFiles = (f > Board::A_FILE ? A_FILE_MASK << (f - 1) : 0) | (f < Board::H_FILE ? A_FILE_MASK << (f + 1) : 0);
+
+			entry.attacks[index] |= AttackTables::pawn(pos, side);
+
+			// A pawn with another pawn of its color in front of it on the file is doubled.
+			if (AttackTables::RAY[forward][pos] & own)
+			{
+				entry.midgame += sign * DOUBLED_MIDGAME;
+				entry.endgame += sign * DOUBLED_ENDGAME;
+			}
+
+			if ((own & neighbourFiles) == 0)
+			{
+				entry.midgame += sign * ISOLATED_MIDGAME;
+				entry.endgame += sign * ISOLATED_ENDGAME;
+			}
+
+			// No enemy pawn in front of the pawn, on its file or a neighbour file, can stop or capture it.
+			if ((enemy & (AttackTables::RAY[forward][pos] | westFront | eastFront)) == 0)
+			{
+				const rank r = side == Board::WHITE ? pos / 8 : Board::RANK_8 - pos / 8;
+				entry.passed[index] |= 1ui64 << pos;
+				entry.midgame += sign * PASSED_MIDGAME[r];
+				entry.endgame += sign * PASSED_ENDGAME[r];
+			}
+		}
+	}
+}
+
+// Pawn shelter score of the king of a side, from the own pawns in front of the king on its file and the neighbour
+// files. The score depends on the king square as well as the pawns, so the entry keeps it for the last king square.
+short PawnTable::shelter(const Board &board, Entry &entry, const color side)
+{
+	const unsigned int index = side / Board::BLACK;
+	unsigned long king = 0;
+	_BitScanForward64(&king, board.bitboard[side + Board::KING]);
+
+	if (entry.kingSquare[index] == king)
+	{
+		return entry.shelter[index];
+	}
+
+	const uint64_t own = board.bitboard[side + Board::PAWN];
+	const int kingFile = king % 8;
+	const int nearRank = (int)king / 8 + (side == Board::WHITE ? 1 : -1);
+	const int farRank = (int)king / 8 + (side == Board::WHITE ? 2 : -2);
+	short score = 0;
+
+	for (int f = kingFile > Board::A_FILE ? kingFile - 1 : kingFile; f <= kingFile + 1 && f <= Board::H_FILE; f++)
+	{
+		const uint64_t fileMask = A_FILE_MASK << f;
+
+		if (nearRank >= Board::RANK_1 && nearRank <= Board::RANK_8 && (own & (1ui64 << (nearRank * 8 + f))))
+			score += SHIELD_NEAR;
+		else if (farRank >= Board::RANK_1 && farRank <= Board::RANK_8 && (own & (1ui64 << (farRank * 8 + f))))
+			score += SHIELD_FAR;
+		else if ((own & fileMask) == 0)
+			score += SHIELD_OPEN;
+	}
+
+	entry.kingSquare[index] = (piece_p)king;
+	entry.shelter[index] = score;
+	return score;
+}
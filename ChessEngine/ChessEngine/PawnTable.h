@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include "Board.h"
+
+namespace chessengine
+{
+
+	// Cache of pawn structure evaluations, keyed by the pawn key of the board.
+	// Pawn configurations repeat far more often than whole positions, so nearly all lookups hit. A table belongs to
+	// a single search thread and needs no synchronisation.
+	class PawnTable
+	{
+
+	public:
+
+		static const unsigned int SIZE = 1 << 13;	// Number of entries, a power of two.
+
+		struct Entry
+		{
+			uint64_t key;
+			uint64_t passed[2];			// Passed pawns, indexed by color / Board::BLACK.
+			uint64_t attacks[2];		// Squares attacked by pawns, indexed by color / Board::BLACK.
+			short midgame;				// White-relative pawn structure scores.
+			short endgame;
+			short shelter[2];			// Midgame pawn shelter score of each king, for the side of the king.
+			piece_p kingSquare[2];		// King squares the shelter scores belong to, Board::NO_SQUARE if none.
+		};
+
+		PawnTable();
+		~PawnTable();
+		PawnTable(const PawnTable &) = delete;
+		PawnTable &operator=(const PawnTable &) = delete;
+
+		void clear();
+		Entry &probe(const Board &board);
+
+		static void evaluate(const Board &board, Entry &entry);
+		static short shelter(const Board &board, Entry &entry, const color side);
+
+	private:
+
+		// Pawn structure terms in centipawns.
+
+		static const short DOUBLED_MIDGAME = -10;
+		static const short DOUBLED_ENDGAME = -25;
+		static const short ISOLATED_MIDGAME = -5;
+		static const short ISOLATED_ENDGAME = -15;
+		static const short PASSED_MIDGAME[8];	// Indexed by the rank relative to the pawn's color.
+		static const short PASSED_ENDGAME[8];
+
+		// Pawn shelter terms, per file of the king and its neighbour files.
+
+		static const short SHIELD_NEAR = 15;	// Own pawn directly in front of the king's rank.
+		static const short SHIELD_FAR = 8;		// Own pawn two ranks in front.
+		static const short SHIELD_OPEN = -15;	// No own pawn on the file.
+
+		Entry *entries;
+
+	};
+
+}
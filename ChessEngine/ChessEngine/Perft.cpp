@@ -0,0 +1,124 @@
+#include <chrono>
+#include "Perft.h"
+#include "MoveGenerator.h"
+#include "Search.h"
+#include "UCI.h"
+
+using namespace chessengine;
+
+// Standard perft positions: the start position, "Kiwipete", and positions 3 to 6 of the Chess Programming Wiki.
+const Perft::Position Perft::SUITE[SUITE_SIZE] =
+{
+	{ "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", { 20, 400, 8902, 197281, 4865609, 119060324 } },
+	{ "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", { 48, 2039, 97862, 4085603, 193690690, 8031647685 } },
+	{ "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", { 14, 191, 2812, 43238, 674624, 11030083 } },
+	{ "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", { 6, 264, 9467, 422333, 15833292, 706045033 } },
+	{ "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", { 44, 1486, 62379, 2103487, 89941194, 3048196529 } },
+	{ "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", { 46, 2079, 89890, 3894594, 164075551, 6923051137 } },
+};
+
+// Number of leaf nodes of the legal move tree of the given depth.
+// The generated moves are legal, so the last level is counted without making its moves.
+uint64_t Perft::perft(Board &board, const color turn, const unsigned int depth)
+{
+	if (depth == 0)
+		return 1;
+
+	MoveList moves;
+	MoveGenerator::generateMoves(board, turn, moves);
+
+	if (depth == 1)
+		return moves.size;
+
+	uint64_t nodes = 0;
+
+	for (const Move &move : moves)
+	{
+		board.makeMove(move, turn);
+		nodes += perft(board, turn ^ Board::BLACK, depth - 1);
+		board.unmakeMove();
+	}
+
+	return nodes;
+}
+
+// Runs perft and prints the node count, time and speed. With divide, the count below every root move is
+// printed as well.
+uint64_t Perft::run(Board &board, const color turn, const unsigned int depth, const bool divide, std::ostream &out)
+{
+	const auto start = std::chrono::steady_clock::now();
+	uint64_t nodes = 0;
+
+	if (divide && depth > 0)
+	{
+		MoveList moves;
+		MoveGenerator::generateMoves(board, turn, moves);
+
+		for (const Move &move : moves)
+		{
+			board.makeMove(move, turn);
+			const uint64_t count = perft(board, turn ^ Board::BLACK, depth - 1);
+			board.unmakeMove();
+
+			out << Search::moveNotation(move) << ": " << count << std::endl;
+			nodes += count;
+		}
+
+		out << std::endl;
+	}
+	else
+	{
+		nodes = perft(board, turn, depth);
+	}
+
+	const long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+	printStats(nodes, ms, out);
+
+	return nodes;
+}
+
+// Runs perft on all suite positions up to maxDepth and compares the counts with the known ones.
+// Returns true if all counts match.
+bool Perft::runSuite(const unsigned int maxDepth, std::ostream &out)
+{
+	const auto start = std::chrono::steady_clock::now();
+	uint64_t totalNodes = 0;
+	bool passed = true;
+
+	for (unsigned int i = 0; i < SUITE_SIZE; i++)
+	{
+		const Position &position = SUITE[i];
+		color turn;
+		Board board = UCI::createBoardFromFen(position.fen, turn);
+
+		out << "Position " << i + 1 << ": " << position.fen << std::endl;
+
+		for (unsigned int depth = 1; depth <= maxDepth && depth <= MAX_DEPTH; depth++)
+		{
+			const uint64_t nodes = perft(board, turn, depth);
+			const bool match = nodes == position.nodes[depth - 1];
+
+			out << "  depth " << depth << ": " << nodes << (match ? " ok" : " FAILED, expected ");
+			if (!match)
+				out << position.nodes[depth - 1];
+			out << std::endl;
+
+			totalNodes += nodes;
+			passed &= match;
+		}
+	}
+
+	const long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+	out << std::endl << (passed ? "All counts match" : "Some counts do not match") << std::endl;
+	printStats(totalNodes, ms, out);
+
+	return passed;
+}
+
+
+void Perft::printStats(const uint64_t nodes, const long long ms, std::ostream &out)
+{
+	out << "Nodes searched: " << nodes << std::endl;
+	out << "Time: " << ms << " ms" << std::endl;
+	out << "Nodes/second: " << nodes * 1000 / (ms > 0 ? ms : 1) << std::endl;
+}
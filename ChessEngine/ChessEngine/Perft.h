@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include "Board.h"
+
+namespace chessengine
+{
+
+	// Move generator verification and benchmarking: counts the leaf nodes of the legal move tree to a fixed depth.
+	// The counts of standard test positions are known, so any difference reveals a move generation bug.
+	class Perft
+	{
+
+	public:
+
+		static uint64_t perft(Board &board, const color turn, const unsigned int depth);
+		static uint64_t run(Board &board, const color turn, const unsigned int depth, const bool divide, std::ostream &out);
+		static bool runSuite(const unsigned int maxDepth, std::ostream &out);
+
+	private:
+
+		// Deepest level of the known node counts.
+		static const unsigned int MAX_DEPTH = 6;
+
+		// A test position and its node counts at depth 1 to MAX_DEPTH.
+		struct Position
+		{
+			const char *fen;
+			uint64_t nodes[MAX_DEPTH];
+		};
+
+		static const unsigned int SUITE_SIZE = 6;
+		static const Position SUITE[SUITE_SIZE];
+
+		static void printStats(const uint64_t nodes, const long long ms, std::ostream &out);
+
+	};
+
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include "Board.h"
+
+namespace chessengine
+{
+
+	// Middlegame and endgame piece-square tables, generated at compile time.
+	// The scores include the material value of the piece and are white-relative: the black tables are the mirrored
+	// and negated white tables, so the board can sum the scores of all pieces.
+	class PieceSquareTables
+	{
+
+	public:
+
+		// Game phase of the starting material. The phase drops towards 0 as pieces are exchanged.
+		static const int MAX_PHASE = 24;
+
+		// A score for every piece (color + type) on every square.
+		struct Table
+		{
+			short score[12][64];
+			constexpr const short (&operator[](const int8_t piece) const)[64] { return score[piece]; }
+		};
+
+		static const Table MIDGAME;
+		static const Table ENDGAME;
+		static const uint8_t PHASE[12];		// Contribution of a piece (color + type) to the game phase.
+
+	};
+
+}
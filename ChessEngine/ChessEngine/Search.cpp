@@ -0,0 +1,584 @@
+#include "Search.h"
+#include "Validator.h"
+#include "Nnue.h"
+#include "Syzygy.h"
+#include "Bitops.h"
+#include <algorithm>
+#include <cstdlib>
+
+using namespace chessengine;
+
+const unsigned int Search::SKIP_SIZE[HELPER_PATTERNS] = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+const unsigned int Search::SKIP_PHASE[HELPER_PATTERNS] = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+Search::Search(const Board &board, const color turn, TranspositionTable &table, PawnTable &pawns, const unsigned int threadId)
+	: board(board), rootColor(turn), threadId(threadId), table(table), nodes(0), tbHits(0), selDepth(0), tbPieces(Syzygy::cardinality()), stop(nullptr), ponder(nullptr), aborted(false),
+	threads(nullptr), info(nullptr), lastReportTime(0), completedDepth(0), completedPvLength(0),
+	pawns(pawns), useNnue(Nnue::active())
+{
+	pvLength[0] = 0;
+}
+
+
+Search::~Search()
+{
+}
+
+// Searches the root position with increasing depth until a limit is reached or stop is set, and returns the
+// score of the last completed iteration. The first iteration is always completed, so there is always a move.
+// When pondering, the time limits only apply once ponder is cleared.
+short Search::run(const SearchLimits &limits, const std::atomic<bool> &stop, const std::atomic<bool> *ponder)
+{
+	const unsigned int maxDepth = limits.depth > 0 && limits.depth < MAX_PLY ? limits.depth : MAX_PLY - 1;
+	long long lastIterationTime = 0;
+	long long previousIterationTime = 0;
+	short score = 0;
+
+	this->limits = limits;
+	this->stop = &stop;
+	this->ponder = ponder;
+	timeManager.start(limits, rootColor);
+	startTime = std::chrono::steady_clock::now();
+
+	if (useNnue)
+		Nnue::refresh(board, accumulators[0]);
+
+	// A tablebase position is played from the tables without searching.
+	if (probeRoot(score))
+	{
+		if (info != nullptr)
+			report(1, true, score);
+		return score;
+	}
+
+	for (unsigned int depth = 1; depth <= maxDepth; depth++)
+	{
+		if (skipIteration(depth))
+			continue;
+
+		const long long iterationStart = timeManager.elapsed();
+		selDepth = 0;
+		const short iterationScore = negamax(depth, 0, -INFINITE_SCORE, INFINITE_SCORE, rootColor);
+
+		if (aborted)
+			break;
+
+		score = iterationScore;
+		completedDepth = depth;
+		completedPvLength = pvLength[0];
+		for (int i = 0; i < pvLength[0]; i++)
+		{
+			completedPv[i] = pv[0][i];
+		}
+
+		if (info != nullptr)
+			report(depth, true, score);
+
+		// A mate within the searched depth will not change with more depth.
+		if (!limits.infinite && (score >= MATE_BOUND || score <= -MATE_BOUND) && MATE_SCORE - std::abs(score) <= (int)depth)
+			break;
+
+		previousIterationTime = lastIterationTime;
+		lastIterationTime = timeManager.elapsed() - iterationStart;
+
+		// Helpers search until the main thread stops them.
+		checkPonderhit();
+		if (threadId == 0 && !timeManager.startNextIteration(lastIterationTime, previousIterationTime))
+			break;
+	}
+
+	return score;
+}
+
+
+bool Search::hasBestMove() const
+{
+	return completedPvLength > 0;
+}
+
+
+Move Search::bestMove() const
+{
+	return completedPv[0];
+}
+
+// Copies the principal variation of the last completed iteration to the moves table and returns its length.
+unsigned int Search::principalVariation(Move *moves) const
+{
+	for (int i = 0; i < completedPvLength; i++)
+	{
+		moves[i] = completedPv[i];
+	}
+	return completedPvLength;
+}
+
+
+uint64_t Search::nodeCount() const
+{
+	return nodes.load(std::memory_order_relaxed);
+}
+
+
+uint64_t Search::tablebaseHits() const
+{
+	return tbHits.load(std::memory_order_relaxed);
+}
+
+// Makes this the main search of the given threads: the node limit and the reported node and tablebase hit counts
+// apply to the sum over all of them.
+void Search::setThreads(const std::vector<Search*> &threads)
+{
+	this->threads = &threads;
+}
+
+// Makes the main search print UCI info lines to out, after every completed iteration and every REPORT_INTERVAL_MS
+// in between.
+void Search::reportTo(std::ostream &out)
+{
+	info = &out;
+}
+
+// Long algebraic notation of a move, as used by UCI.
+std::string Search::moveNotation(const Move &move)
+{
+	static const char PROMOTION_SUFFIX[6] = { 'p', 'r', 'n', 'b', 'q', 'k' };
+
+	std::string notation = Board::squareNotation(move.pos()) + Board::squareNotation(move.dest());
+	if (move.kind() == Move::PROMOTION)
+		notation += PROMOTION_SUFFIX[move.promotion()];
+	return notation;
+}
+
+// UCI notation of a score: centipawns, or the moves to mate, negative when getting mated.
+std::string Search::scoreNotation(const short score)
+{
+	if (score >= MATE_BOUND)
+		return "mate " + std::to_string((MATE_SCORE - score + 1) / 2);
+	if (score <= -MATE_BOUND)
+		return "mate " + std::to_string(-(MATE_SCORE + score) / 2);
+	return "cp " + std::to_string(score);
+}
+
+
+short Search::negamax(const int depth, const int ply, short alpha, short beta, const color turn)
+{
+	pvLength[ply] = ply;
+
+	if ((countNode() & 0x3FF) == 0)
+	{
+		checkAbort();
+	}
+
+	if (ply > selDepth)
+	{
+		selDepth = ply;
+	}
+
+	if (aborted)
+	{
+		return 0;
+	}
+
+	// A repetition or the fifty-move rule ends the line in a draw.
+	if (ply > 0 && board.isDraw())
+	{
+		return 0;
+	}
+
+	if (depth <= 0 || ply >= MAX_PLY - 1)
+	{
+		return quiescence(ply, alpha, beta, turn);
+	}
+
+	const uint64_t key = board.hash(turn);
+
+	// A stored result of sufficient depth can end the search of this node, except at the root where a move is needed.
+	// Any entry provides the hash move, which is searched first.
+	TranspositionTable::Entry entry;
+	uint16_t hashMove = 0;
+	if (table.probe(key, entry))
+	{
+		hashMove = entry.move;
+
+		if (ply > 0 && entry.depth >= depth)
+		{
+			const short score = scoreFromTable(entry.score, ply);
+
+			if (entry.bound == TranspositionTable::BOUND_EXACT
+				|| (entry.bound == TranspositionTable::BOUND_LOWER && score >= beta)
+				|| (entry.bound == TranspositionTable::BOUND_UPPER && score <= alpha))
+			{
+				return score;
+			}
+		}
+	}
+
+	// Tablebase results end the search of the node. A win is only a lower bound and a loss an upper bound, so
+	// that a mate or a faster win can still be found by searching.
+	if (ply > 0 && tbPieces > 0 && board.castlingRights() == 0 && bitcount(board.positionMask()) <= tbPieces)
+	{
+		int wdl;
+		if (Syzygy::probeWdl(board, turn, wdl))
+		{
+			tbHits.store(tbHits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+			const short score = tablebaseScore(wdl, ply);
+			const uint8_t bound = wdl == Syzygy::WIN ? TranspositionTable::BOUND_LOWER
+				: wdl == Syzygy::LOSS ? TranspositionTable::BOUND_UPPER
+				: TranspositionTable::BOUND_EXACT;
+
+			if (bound == TranspositionTable::BOUND_EXACT
+				|| (bound == TranspositionTable::BOUND_LOWER && score >= beta)
+				|| (bound == TranspositionTable::BOUND_UPPER && score <= alpha))
+			{
+				table.store(key, 0, scoreToTable(score, ply), (uint8_t)std::min(depth + 6, MAX_PLY - 1), bound);
+				return score;
+			}
+		}
+	}
+
+	const Move none = Move::none();
+	const Move &previous = ply > 0 ? currentMove[ply - 1] : none;
+
+	ScoredMoveList list;
+	MoveGenerator::generateMoves(board, turn, list);
+
+	// no legal moves: checkmate or stalemate
+	if (list.size == 0)
+	{
+		return board.isKingCheck(turn) ? -MATE_SCORE + ply : 0;
+	}
+
+	ordering.score(board, turn, list, hashMove, ply, previous);
+
+	Move quiets[MoveGenerator::MAX_MOVES];
+	unsigned int quietCount = 0;
+	const short alphaOrig = alpha;
+	short bestScore = -INFINITE_SCORE;
+	uint16_t best = 0;
+
+	for (unsigned int i = 0; i < list.size; i++)
+	{
+		const Move move = list.pick(i);
+		const bool quiet = MoveOrdering::isQuiet(board, move);
+
+		makeMove(move, turn, ply);
+		currentMove[ply] = move;
+		const short score = -negamax(depth - 1, ply + 1, -beta, -alpha, turn ^ Board::BLACK);
+		board.unmakeMove();
+
+		// The result of an aborted search is incomplete and must not be used.
+		if (aborted)
+			return 0;
+
+		if (score > bestScore)
+		{
+			bestScore = score;
+			best = move.pack();
+
+			if (score > alpha)
+			{
+				alpha = score;
+				updatePv(ply, move);
+
+				if (alpha >= beta)
+				{
+					// Quiet refutations are remembered for ordering at other nodes.
+					if (quiet)
+						ordering.update(board, turn, move, quiets, quietCount, depth, ply, previous);
+					break;
+				}
+			}
+		}
+
+		if (quiet)
+			quiets[quietCount++] = move;
+	}
+
+	const uint8_t bound = bestScore >= beta ? TranspositionTable::BOUND_LOWER
+		: bestScore > alphaOrig ? TranspositionTable::BOUND_EXACT
+		: TranspositionTable::BOUND_UPPER;
+
+	table.store(key, best, scoreToTable(bestScore, ply), depth, bound);
+
+	return bestScore;
+}
+
+// Searches captures and promotions only, until the position is quiet, so that leaves are not evaluated in the
+// middle of an exchange. The side to move may stand pat, i.e. take the static evaluation instead of capturing,
+// except when in check: then all evasions are searched, and a position without any is mate.
+short Search::quiescence(const int ply, short alpha, const short beta, const color turn)
+{
+	pvLength[ply] = ply;
+
+	if ((countNode() & 0x3FF) == 0)
+	{
+		checkAbort();
+	}
+
+	if (ply > selDepth)
+	{
+		selDepth = ply;
+	}
+
+	if (aborted)
+	{
+		return 0;
+	}
+
+	const bool inCheck = board.isKingCheck(turn);
+	short standPat = -MATE_SCORE + ply;
+
+	if (!inCheck || ply >= MAX_PLY - 1)
+	{
+		standPat = evaluate(turn, ply);
+
+		if (standPat >= beta || ply >= MAX_PLY - 1)
+		{
+			return standPat;
+		}
+
+		if (standPat > alpha)
+		{
+			alpha = standPat;
+		}
+	}
+
+	ScoredMoveList list;
+	if (inCheck)
+	{
+		MoveGenerator::generateMoves(board, turn, list);
+
+		if (list.size == 0)
+		{
+			return -MATE_SCORE + ply;
+		}
+	}
+	else
+	{
+		MoveGenerator::generateCaptures(board, turn, list);
+	}
+	ordering.score(board, turn, list, 0, ply, Move::none());
+
+	short bestScore = standPat;
+
+	for (unsigned int i = 0; i < list.size; i++)
+	{
+		const Move move = list.pick(i);
+		const piece_t captured = move.kind() == Move::EN_PASSANT ? Board::PAWN : board.pieceType(move.dest());
+		short gain = captured == Board::EMPTY ? 0 : Board::PIECE_VALUE[captured];
+
+		if (move.kind() == Move::PROMOTION)
+		{
+			gain += Board::PIECE_VALUE[move.promotion()] - Board::PIECE_VALUE[Board::PAWN];
+		}
+
+		// Delta pruning: skip captures that cannot raise the score to alpha even with a positional margin.
+		if (!inCheck && standPat + gain + DELTA_MARGIN <= alpha)
+			continue;
+
+		makeMove(move, turn, ply);
+		const short score = -quiescence(ply + 1, -beta, -alpha, turn ^ Board::BLACK);
+		board.unmakeMove();
+
+		if (aborted)
+			return 0;
+
+		if (score > bestScore)
+		{
+			bestScore = score;
+
+			if (score > alpha)
+			{
+				alpha = score;
+
+				if (alpha >= beta)
+					break;
+			}
+		}
+	}
+
+	return bestScore;
+}
+
+// Sets the abort flag when the search is stopped or a limit is reached. The main thread only aborts after the
+// first iteration has completed, so that there is always a move to play.
+void Search::checkAbort()
+{
+	if (threadId != 0)
+	{
+		aborted = stop->load(std::memory_order_relaxed);
+		return;
+	}
+
+	if (completedDepth == 0)
+		return;
+
+	checkPonderhit();
+
+	if (info != nullptr)
+	{
+		const long long time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+		if (time - lastReportTime >= REPORT_INTERVAL_MS)
+			report(completedDepth + 1, false, 0);
+	}
+
+	if (stop->load(std::memory_order_relaxed)
+		|| timeManager.hardLimitReached()
+		|| (limits.nodes && totalNodeCount() >= limits.nodes))
+	{
+		aborted = true;
+	}
+}
+
+// Nodes searched by all threads of the search.
+uint64_t Search::totalNodeCount() const
+{
+	if (threads == nullptr)
+		return nodeCount();
+
+	uint64_t total = 0;
+	for (const Search *search : *threads)
+		total += search->nodeCount();
+	return total;
+}
+
+// Switches the time manager from pondering to the normal limits once the ponder hit has cleared ponder.
+void Search::checkPonderhit()
+{
+	if (timeManager.isPondering() && (ponder == nullptr || !ponder->load(std::memory_order_relaxed)))
+		timeManager.ponderhit();
+}
+
+// True if a helper thread skips the iteration of the given depth. The main thread searches every depth.
+bool Search::skipIteration(const unsigned int depth) const
+{
+	if (threadId == 0)
+		return false;
+
+	const unsigned int i = (threadId - 1) % HELPER_PATTERNS;
+	return ((depth + SKIP_PHASE[i]) / SKIP_SIZE[i]) % 2 != 0;
+}
+
+// Makes a move at the given ply and updates the network accumulator of the next ply. Moves are taken back with
+// board.unmakeMove, the accumulator of the ply is still valid then.
+void Search::makeMove(const Move move, const color turn, const int ply)
+{
+	board.makeMove(move, turn);
+
+	if (useNnue)
+		Nnue::update(board, accumulators[ply], accumulators[ply + 1]);
+}
+
+// Static evaluation relative to the side to move, by the network if one is active, else by the Validator.
+short Search::evaluate(const color turn, const int ply)
+{
+	if (useNnue)
+	{
+		// The network output is not bounded, and must stay clear of the tablebase and mate scores.
+		const int score = Nnue::evaluate(accumulators[ply], turn);
+		return (short)std::max(-TB_WIN_BOUND + 1, std::min(score, TB_WIN_BOUND - 1));
+	}
+
+	const short score = Validator::validate(board, pawns);
+	return turn == Board::WHITE ? score : -score;
+}
+
+// Sets the principal variation of a ply to the move followed by the principal variation of the next ply.
+void Search::updatePv(const int ply, const Move &move)
+{
+	pv[ply][ply] = move;
+
+	for (int i = ply + 1; i < pvLength[ply + 1]; i++)
+	{
+		pv[ply][i] = pv[ply + 1][i];
+	}
+
+	pvLength[ply] = pvLength[ply + 1];
+}
+
+// Mate and tablebase scores are stored relative to the node rather than the root, so they stay valid when the
+// position is reached at another ply.
+short Search::scoreToTable(const short score, const int ply)
+{
+	if (score >= TB_WIN_BOUND) return score + ply;
+	if (score <= -TB_WIN_BOUND) return score - ply;
+	return score;
+}
+
+
+short Search::scoreFromTable(const short score, const int ply)
+{
+	if (score >= TB_WIN_BOUND) return score - ply;
+	if (score <= -TB_WIN_BOUND) return score + ply;
+	return score;
+}
+
+// Score of a tablebase result found at a ply. Cursed wins and blessed losses are draws by the fifty-move rule, they
+// only score a little above and below a draw.
+short Search::tablebaseScore(const int wdl, const int ply)
+{
+	if (wdl == Syzygy::WIN) return TB_WIN_SCORE - ply;
+	if (wdl == Syzygy::LOSS) return -TB_WIN_SCORE + ply;
+	return (short)wdl;
+}
+
+// Takes the best move of a root position in the tablebases, the one that keeps the result with the best distance
+// to zeroing, as the result of the search. Returns false if the position is not in the tables.
+bool Search::probeRoot(short &score)
+{
+	if (tbPieces == 0 || board.castlingRights() != 0 || bitcount(board.positionMask()) > tbPieces)
+		return false;
+
+	Move move;
+	int wdl;
+	int dtz;
+	if (!Syzygy::probeRoot(board, rootColor, move, wdl, dtz))
+		return false;
+
+	tbHits.store(tbHits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	score = tablebaseScore(wdl, 0);
+	completedDepth = 1;
+	completedPv[0] = move;
+	completedPvLength = 1;
+	return true;
+}
+
+// Prints a UCI info line: the depth searched, the counters of all threads and the fill of the table, and for a
+// completed iteration also its score and principal variation. The line is written with a single call, so it is
+// not mixed with the output of the UCI thread.
+void Search::report(const unsigned int depth, const bool completed, const short score)
+{
+	const long long time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+
+	const uint64_t totalNodes = totalNodeCount();
+	uint64_t totalTbHits = tablebaseHits();
+	if (threads != nullptr)
+	{
+		totalTbHits = 0;
+		for (const Search *search : *threads)
+			totalTbHits += search->tablebaseHits();
+	}
+
+	std::string line = "info depth " + std::to_string(depth) + " seldepth " + std::to_string(selDepth);
+	if (completed)
+		line += " score " + scoreNotation(score);
+	line += " nodes " + std::to_string(totalNodes)
+		+ " nps " + std::to_string(totalNodes * 1000 / (time > 0 ? time : 1))
+		+ " time " + std::to_string(time)
+		+ " hashfull " + std::to_string(table.hashfull())
+		+ " tbhits " + std::to_string(totalTbHits);
+
+	if (completed && completedPvLength > 0)
+	{
+		line += " pv";
+		for (int i = 0; i < completedPvLength; i++)
+		{
+			line += " " + moveNotation(completedPv[i]);
+		}
+	}
+
+	line += "\n";
+	*info << line << std::flush;
+	lastReportTime = time;
+}
@@ -0,0 +1,143 @@
+#pragma once
+#include <cstdint>
+#include "Board.h"
+#include "MoveGenerator.h"
+#include "MoveOrdering.h"
+#include "TranspositionTable.h"
+#include "TimeManager.h"
+#include "Nnue.h"
+#include "PawnTable.h"
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace chessengine
+{
+
+	// Iterative deepening negamax alpha-beta search on a single board.
+	// Moves are made and taken back in place, and all per-ply state lives in fixed-size tables, so the
+	// search allocates no memory per node.
+	class Search
+	{
+
+	public:
+
+		static const int MAX_PLY = MoveOrdering::MAX_PLY;
+
+		// Scores, relative to the side to move.
+
+		static const short INFINITE_SCORE = 32001;
+		static const short MATE_SCORE = 32000;
+		static const short MATE_BOUND = MATE_SCORE - MAX_PLY;
+
+		// Tablebase wins score below all mates and above all evaluations, less the ply they are found at.
+		static const short TB_WIN_SCORE = MATE_BOUND - 1;
+		static const short TB_WIN_BOUND = TB_WIN_SCORE - MAX_PLY;
+
+		// Margin of delta pruning in quiescence search: captures that cannot bring the score within this margin
+		// of alpha are skipped.
+		static const short DELTA_MARGIN = 200;
+
+		// Interval of the progress reports sent while an iteration is searched, in milliseconds.
+		static const long long REPORT_INTERVAL_MS = 1000;
+
+		Search(const Board &board, const color turn, TranspositionTable &table, PawnTable &pawns, const unsigned int threadId = 0);
+		~Search();
+
+		short run(const SearchLimits &limits, const std::atomic<bool> &stop, const std::atomic<bool> *ponder = nullptr);
+		bool hasBestMove() const;
+		Move bestMove() const;
+		unsigned int principalVariation(Move *moves) const;
+		uint64_t nodeCount() const;
+		uint64_t tablebaseHits() const;
+		void setThreads(const std::vector<Search*> &threads);
+		void reportTo(std::ostream &out);
+
+		static std::string moveNotation(const Move &move);
+		static std::string scoreNotation(const short score);
+
+	private:
+
+		short negamax(const int depth, const int ply, short alpha, short beta, const color turn);
+		short quiescence(const int ply, short alpha, const short beta, const color turn);
+		void checkAbort();
+		uint64_t totalNodeCount() const;
+		void checkPonderhit();
+		void makeMove(const Move move, const color turn, const int ply);
+		short evaluate(const color turn, const int ply);
+		void updatePv(const int ply, const Move &move);
+		bool probeRoot(short &score);
+		void report(const unsigned int depth, const bool completed, const short score);
+
+		// Counts a node. Only the owning thread writes the counter, so it needs no atomic increment, while other
+		// threads can read it at any time to report the total.
+		inline uint64_t countNode()
+		{
+			const uint64_t count = nodes.load(std::memory_order_relaxed) + 1;
+			nodes.store(count, std::memory_order_relaxed);
+			return count;
+		}
+
+		static short tablebaseScore(const int wdl, const int ply);
+
+		static short scoreToTable(const short score, const int ply);
+		static short scoreFromTable(const short score, const int ply);
+
+		// Iterations skipped by helper threads, so that the threads of a Lazy SMP search are spread over
+		// different depths. Indexed by (threadId - 1) % HELPER_PATTERNS.
+		static const unsigned int HELPER_PATTERNS = 20;
+		static const unsigned int SKIP_SIZE[HELPER_PATTERNS];
+		static const unsigned int SKIP_PHASE[HELPER_PATTERNS];
+
+		bool skipIteration(const unsigned int depth) const;
+
+		Board board;
+		const color rootColor;
+		const unsigned int threadId;	// 0 for the main thread, which alone manages time.
+		TranspositionTable &table;
+		std::atomic<uint64_t> nodes;
+		std::atomic<uint64_t> tbHits;
+		int selDepth;					// Deepest ply reached in the current iteration.
+		const unsigned int tbPieces;	// Pieces of the largest positions to probe in the tablebases, 0 if none.
+
+		// Search limits and abort state.
+		SearchLimits limits;
+		TimeManager timeManager;
+		const std::atomic<bool> *stop;
+		const std::atomic<bool> *ponder;	// Set while pondering, cleared by the ponder hit.
+		bool aborted;
+
+		// Threads searching the position with the main thread, whose counters it sums for the node limit and the info
+		// lines. Null for a single search.
+		const std::vector<Search*> *threads;
+
+		// UCI info output of the main thread, null if the search is silent.
+		std::ostream *info;
+		std::chrono::steady_clock::time_point startTime;
+		long long lastReportTime;
+
+		// Result of the last completed iteration.
+		unsigned int completedDepth;
+		Move completedPv[MAX_PLY];
+		int completedPvLength;
+
+		// Move ordering heuristics and the move made at each ply of the current line, used for countermoves.
+		MoveOrdering ordering;
+		Move currentMove[MAX_PLY];
+
+		// Pawn structure cache of the handcrafted evaluation, kept by the thread across searches.
+		PawnTable &pawns;
+
+		// Network accumulators of the positions of the current line, indexed by ply.
+		const bool useNnue;
+		Nnue::Accumulator accumulators[MAX_PLY];
+
+		// Triangular principal variation table, row ply holds the best line found from that ply.
+		Move pv[MAX_PLY][MAX_PLY];
+		int pvLength[MAX_PLY];
+
+	};
+
+}
@@ -0,0 +1,171 @@
+#include <intrin.h>
+#include <vector>
+#include "SlidingAttacks.h"
+#include "Bitops.h"
+
+using namespace chessengine;
+
+SlidingAttacks::Entry SlidingAttacks::rookEntry[64];
+SlidingAttacks::Entry SlidingAttacks::bishopEntry[64];
+uint64_t SlidingAttacks::rookTable[ROOK_TABLE_SIZE];
+uint64_t SlidingAttacks::bishopTable[BISHOP_TABLE_SIZE];
+bool SlidingAttacks::pext = false;
+
+static const int ROOK_DIRECTIONS[4][2] = { { 0, 1 }, { 1, 0 }, { 0, -1 }, { -1, 0 } };
+static const int BISHOP_DIRECTIONS[4][2] = { { 1, 1 }, { 1, -1 }, { -1, -1 }, { -1, 1 } };
+
+// PRNG seeds per rank, chosen so that the magic search terminates quickly.
+static const uint64_t MAGIC_SEEDS[8] = { 728, 10316, 55013, 32803, 12281, 15100, 16645, 255 };
+
+// Fills the rook and bishop attack tables. Must be called once before any lookup.
+void SlidingAttacks::init()
+{
+	pext = detectPext();
+	initPiece(rookEntry, rookTable, ROOK_DIRECTIONS);
+	initPiece(bishopEntry, bishopTable, BISHOP_DIRECTIONS);
+}
+
+
+bool SlidingAttacks::usesPext()
+{
+	return pext;
+}
+
+// Table index of the occupancy using PEXT. MSVC inlines the instruction in index(), other compilers only accept it
+// in code compiled for BMI2, which would allow BMI2 everywhere if enabled for the whole program.
+#if defined(__GNUC__)
+__attribute__((target("bmi2")))
+#endif
+unsigned int SlidingAttacks::pextIndex(const Entry &e, const uint64_t occupancy)
+{
+	return (unsigned int)_pext_u64(occupancy, e.mask);
+}
+
+// True if the CPU supports BMI2 and implements PEXT in hardware.
+// AMD processors prior to Zen 3 (family 0x17 and older) microcode PEXT, which is slower than magic multiplication.
+bool SlidingAttacks::detectPext()
+{
+	int regs[4];
+
+	__cpuidex(regs, 0, 0);
+	const int maxLeaf = regs[0];
+	const bool amd = regs[1] == 0x68747541; // "Auth"enticAMD
+
+	if (maxLeaf < 7)
+		return false;
+
+	__cpuidex(regs, 1, 0);
+	const int family = ((regs[0] >> 8) & 0xF) + ((regs[0] >> 20) & 0xFF);
+
+	__cpuidex(regs, 7, 0);
+	const bool bmi2 = (regs[1] & (1 << 8)) != 0;
+
+	return bmi2 && !(amd && family < 0x19);
+}
+
+// Computes the attack set of a slider by walking each ray until it hits an occupied square or the board edge.
+uint64_t SlidingAttacks::rayAttacks(const int directions[4][2], const piece_p pos, const uint64_t occupancy)
+{
+	uint64_t attacks = 0;
+
+	for (int d = 0; d < 4; d++)
+	{
+		int f = pos % 8 + directions[d][0];
+		int r = pos / 8 + directions[d][1];
+
+		while (f >= 0 && f < 8 && r >= 0 && r < 8)
+		{
+			uint64_t sq = 1ui64 << (r * 8 + f);
+			attacks |= sq;
+
+			if (occupancy & sq)
+				break;
+
+			f += directions[d][0];
+			r += directions[d][1];
+		}
+	}
+
+	return attacks;
+}
+
+// Computes the relevant occupancy masks and fills the attack table for one piece type.
+// With PEXT the index is the occupancy compressed by the mask, otherwise a magic number is searched for every square.
+void SlidingAttacks::initPiece(Entry *entries, uint64_t *table, const int directions[4][2])
+{
+	std::vector<uint64_t> occupancy(4096);
+	std::vector<uint64_t> reference(4096);
+	std::vector<unsigned int> epoch(4096, 0);
+	unsigned int attempt = 0;
+	uint64_t *attacks = table;
+
+	for (piece_p pos = 0; pos < 64; pos++)
+	{
+		Entry &e = entries[pos];
+
+		// Pieces on the board edge never block any further squares, so they are excluded from the mask.
+		const uint64_t rankEdges = (0xFFui64 | 0xFFui64 << 56) & ~(0xFFui64 << (pos / 8) * 8);
+		const uint64_t fileEdges = (0x101010101010101ui64 | 0x8080808080808080ui64) & ~(0x101010101010101ui64 << pos % 8);
+
+		e.mask = rayAttacks(directions, pos, 0) & ~(rankEdges | fileEdges);
+		e.shift = 64 - bitcount(e.mask);
+		e.attacks = attacks;
+		e.magic = 0;
+
+		// Enumerate all subsets of the mask (Carry-Rippler).
+		unsigned int size = 0;
+		uint64_t sub = 0;
+		do
+		{
+			occupancy[size] = sub;
+			reference[size] = rayAttacks(directions, pos, sub);
+
+			if (pext)
+				attacks[pextIndex(e, sub)] = reference[size];
+
+			size++;
+			sub = (sub - e.mask) & e.mask;
+		} while (sub);
+
+		if (!pext)
+		{
+			uint64_t seed = MAGIC_SEEDS[pos / 8];
+			unsigned int i = 0;
+			while (i < size)
+			{
+				// Sparse random candidates make good magics.
+				do
+				{
+					uint64_t candidate = ~0ui64;
+					for (int n = 0; n < 3; n++)
+					{
+						seed ^= seed >> 12;
+						seed ^= seed << 25;
+						seed ^= seed >> 27;
+						candidate &= seed * 0x2545F4914F6CDD1Dui64;
+					}
+					e.magic = candidate;
+				} while (bitcount((e.mask * e.magic) >> 56) < 6);
+
+				// Verify that the candidate maps every occupancy to an index without destructive collisions.
+				attempt++;
+				for (i = 0; i < size; i++)
+				{
+					unsigned int idx = (unsigned int)(((occupancy[i] & e.mask) * e.magic) >> e.shift);
+
+					if (epoch[idx] < attempt)
+					{
+						epoch[idx] = attempt;
+						attacks[idx] = reference[i];
+					}
+					else if (attacks[idx] != reference[i])
+					{
+						break;
+					}
+				}
+			}
+		}
+
+		attacks += size;
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+#include <immintrin.h>
+#include "Board.h"
+
+namespace chessengine
+{
+
+	// Table driven attack sets for the sliding pieces (rook, bishop, queen).
+	// The attack set of a square is looked up using the relevant occupancy as index, either through
+	// magic multiplication or, on CPUs with fast BMI2 support, the PEXT instruction.
+	class SlidingAttacks
+	{
+
+	public:
+
+		// Number of attack table entries for all squares.
+		static const unsigned int ROOK_TABLE_SIZE = 0x19000;
+		static const unsigned int BISHOP_TABLE_SIZE = 0x1480;
+
+		// Lookup data for one square.
+		struct Entry
+		{
+			uint64_t mask;		// Relevant occupancy (ray squares excluding the board edge).
+			uint64_t magic;		// Magic multiplier.
+			uint64_t *attacks;	// Start of this square's slice of the attack table.
+			unsigned int shift;	// 64 - number of relevant occupancy bits.
+		};
+
+		static void init();
+		static bool usesPext();
+
+		// Rook attacks from a square, given the occupancy of the board.
+		static inline uint64_t rook(const piece_p pos, const uint64_t occupancy)
+		{
+			const Entry &e = rookEntry[pos];
+			return e.attacks[index(e, occupancy)];
+		}
+
+		// Bishop attacks from a square, given the occupancy of the board.
+		static inline uint64_t bishop(const piece_p pos, const uint64_t occupancy)
+		{
+			const Entry &e = bishopEntry[pos];
+			return e.attacks[index(e, occupancy)];
+		}
+
+		// Queen attacks from a square, given the occupancy of the board.
+		static inline uint64_t queen(const piece_p pos, const uint64_t occupancy)
+		{
+			return rook(pos, occupancy) | bishop(pos, occupancy);
+		}
+
+	private:
+
+		static Entry rookEntry[64];
+		static Entry bishopEntry[64];
+		static uint64_t rookTable[ROOK_TABLE_SIZE];
+		static uint64_t bishopTable[BISHOP_TABLE_SIZE];
+		static bool pext;
+
+		static inline unsigned int index(const Entry &e, const uint64_t occupancy)
+		{
+			if (pext)
+#if defined(_MSC_VER)
+				return (unsigned int)_pext_u64(occupancy, e.mask);
+#else
+				return pextIndex(e, occupancy);
+#endif
+
+			return (unsigned int)(((occupancy & e.mask) * e.magic) >> e.shift);
+		}
+
+		static unsigned int pextIndex(const Entry &e, const uint64_t occupancy);
+		static bool detectPext();
+		static void initPiece(Entry *entries, uint64_t *table, const int directions[4][2]);
+		static uint64_t rayAttacks(const int directions[4][2], const piece_p pos, const uint64_t occupancy);
+	};
+
+}
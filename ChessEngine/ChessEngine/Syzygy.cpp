@@ -0,0 +1,1233 @@
+#include "Syzygy.h"
+#include "MoveGenerator.h"
+#include "MappedFile.h"
+#include "Bitops.h"
+#include "UCI.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+using namespace chessengine;
+
+// The index computation and the decompression follow the layout of the files written by the Syzygy generator.
+// The tables are split by the file of the leading pawn, and positions are mirrored so that the leading piece is
+// in a canonical part of the board. The values of a table are compressed with recursive pairing and canonical
+// Huffman codes in blocks of fixed size.
+
+namespace
+{
+
+	// Outcome of a probe.
+	enum ProbeState
+	{
+		FAIL,				// The table is missing or unreadable.
+		OK,
+		CHANGE_STM,			// The DTZ table stores the other side to move.
+		ZEROING_BEST_MOVE	// The best move is a capture or pawn move, the table value does not apply.
+	};
+
+	// Table flags
+
+	const uint8_t FLAG_STM = 1;
+	const uint8_t FLAG_MAPPED = 2;
+	const uint8_t FLAG_WIN_PLIES = 4;
+	const uint8_t FLAG_LOSS_PLIES = 8;
+	const uint8_t FLAG_WIDE = 16;
+	const uint8_t FLAG_SINGLE_VALUE = 128;
+
+	const uint8_t WDL_MAGIC[4] = { 0x71, 0xE8, 0x23, 0x5D };
+	const uint8_t DTZ_MAGIC[4] = { 0xD7, 0x66, 0x0C, 0xA5 };
+
+	// Compressed values of one side to move and leading pawn file of a table.
+	struct PairsData
+	{
+		uint8_t flags;
+		uint8_t maxSymLen;				// Longest and shortest Huffman code, in bits. A single value table
+		uint8_t minSymLen;				// stores its value in minSymLen.
+		uint32_t numBlocks;
+		size_t sizeofBlock;
+		size_t span;					// Values between two sparse index entries.
+		const uint8_t *lowestSym;		// Lowest symbol of every code length, 16 bits each.
+		const uint8_t *btree;			// Left and right symbol of every pair symbol, 12 bits each.
+		const uint8_t *blockLength;		// Number of values - 1 of every block, 16 bits each.
+		uint32_t blockLengthSize;
+		const uint8_t *sparseIndex;		// Block (32 bits) and offset in the block (16 bits) of every span.
+		size_t sparseIndexSize;
+		const uint8_t *data;			// Start of the compressed blocks.
+		std::vector<uint64_t> base64;	// Lowest code of every length, left aligned in 64 bits.
+		std::vector<uint8_t> symlen;	// Number of values - 1 a symbol expands to.
+		uint8_t pieces[Syzygy::MAX_PIECES];
+		uint64_t groupIdx[Syzygy::MAX_PIECES + 1];
+		int groupLen[Syzygy::MAX_PIECES + 1];
+		uint16_t mapIdx[4];				// Value maps of a DTZ table, by WDL result.
+	};
+
+	// WDL or DTZ file of a table, mapped on first use.
+	struct TableFile
+	{
+		MappedFile file;
+		std::atomic<bool> ready;
+		bool valid;
+		PairsData items[2][4];			// By side to move (WDL only) and leading pawn file.
+		const uint8_t *map;				// DTZ value maps.
+
+		TableFile()
+			: ready(false), valid(false), map(nullptr)
+		{
+		}
+	};
+
+	// A material configuration, stronger side first in the name, like KRPvKR.
+	struct Table
+	{
+		std::string name;
+		uint64_t key;					// Material keys with the first side white and with it black.
+		uint64_t key2;
+		int pieceCount;
+		bool hasPawns;
+		bool hasUniquePieces;
+		int pawnCount[2];				// Pawns of the leading color, the side with fewer pawns, and of the other.
+		TableFile wdl;
+		TableFile dtz;
+	};
+
+	// Table piece codes by piece (color + type): pawn, knight, bishop, rook, queen, king are 1 to 6, black adds 8.
+	const uint8_t TB_PIECE[12] = { 1, 4, 2, 3, 5, 6, 9, 12, 10, 11, 13, 14 };
+
+	// Piece types from the strongest down, the order of the piece letters in the file names.
+	const piece_t NAME_ORDER[6] = { Board::KING, Board::QUEEN, Board::ROOK, Board::BISHOP, Board::KNIGHT, Board::PAWN };
+	const char NAME_LETTER[6] = { 'P', 'R', 'N', 'B', 'Q', 'K' };
+
+#ifdef _WIN32
+	const char PATH_SEPARATOR = ';';
+#else
+	const char PATH_SEPARATOR = ':';
+#endif
+
+	// Index tables
+	int MapPawns[64];
+	int MapB1H1H7[64];
+	int MapA1D1D4[64];
+	int MapKK[10][64];
+	int Binomial[6][64];
+	int LeadPawnIdx[6][64];
+	int LeadPawnsSize[6][4];
+
+	std::vector<std::unique_ptr<Table>> tables;
+	std::unordered_map<uint64_t, Table *> tableIndex;
+	std::vector<std::string> directories;
+	std::mutex mappingMutex;
+
+}
+
+unsigned int Syzygy::largest = 0;
+unsigned int Syzygy::probeLimit = Syzygy::MAX_PIECES;
+
+// KQvK and KRvK positions. Without pawns or captures for the winning side, the DTZ is the distance to mate, which
+// was computed by a separate retrograde analysis.
+const Syzygy::Position Syzygy::SUITE[Syzygy::SUITE_SIZE] =
+{
+	{ "7k/8/6K1/8/8/8/8/1Q6 w - - 0 1", Syzygy::WIN, 1, Syzygy::WIN },
+	{ "4k3/8/8/8/8/8/8/3QK3 w - - 0 1", Syzygy::WIN, 15, Syzygy::WIN },
+	{ "4k3/8/8/8/8/8/8/3QK3 b - - 0 1", Syzygy::LOSS, -16, Syzygy::LOSS },
+	{ "4k3/4Q3/8/8/8/8/8/K7 b - - 0 1", Syzygy::DRAW, 0, Syzygy::DRAW },
+	{ "4k3/8/8/8/8/8/8/R3K3 w - - 0 1", Syzygy::WIN, 23, Syzygy::WIN },
+	{ "4k3/8/8/8/8/8/8/R3K3 b - - 0 1", Syzygy::LOSS, -28, Syzygy::LOSS },
+	{ "8/8/8/8/8/8/6Rk/K7 b - - 0 1", Syzygy::DRAW, 0, Syzygy::DRAW },
+	{ "4k3/8/8/8/8/8/8/R3K3 w - - 70 1", Syzygy::WIN, 23, Syzygy::WIN },
+	{ "4k3/8/8/8/8/8/8/R3K3 w - - 90 1", Syzygy::WIN, 23, Syzygy::CURSED_WIN },
+	{ "4k3/8/8/8/8/8/8/R3K3 b - - 30 1", Syzygy::LOSS, -28, Syzygy::LOSS },
+	{ "4k3/8/8/8/8/8/8/R3K3 b - - 80 1", Syzygy::LOSS, -28, Syzygy::BLESSED_LOSS },
+};
+
+static inline int rankOf(const int square)
+{
+	return square >> 3;
+}
+
+static inline int fileOf(const int square)
+{
+	return square & 7;
+}
+
+// Distance from the a1-h8 diagonal, negative below it.
+static inline int offA1H8(const int square)
+{
+	return rankOf(square) - fileOf(square);
+}
+
+static inline bool pawnsCompare(const int a, const int b)
+{
+	return MapPawns[a] < MapPawns[b];
+}
+
+static inline uint16_t readLittleEndian16(const uint8_t *p)
+{
+	return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static inline uint32_t readLittleEndian32(const uint8_t *p)
+{
+	return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static inline uint32_t readBigEndian32(const uint8_t *p)
+{
+	return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | (uint32_t)p[3];
+}
+
+static inline uint64_t readBigEndian64(const uint8_t *p)
+{
+	return (uint64_t)readBigEndian32(p) << 32 | readBigEndian32(p + 4);
+}
+
+static inline uint16_t leftSymbol(const PairsData &d, const uint16_t sym)
+{
+	const uint8_t *lr = d.btree + 3 * sym;
+	return (uint16_t)((lr[1] & 0xF) << 8 | lr[0]);
+}
+
+static inline uint16_t rightSymbol(const PairsData &d, const uint16_t sym)
+{
+	const uint8_t *lr = d.btree + 3 * sym;
+	return (uint16_t)(lr[2] << 4 | lr[1] >> 4);
+}
+
+// Material key of the piece counts, the same for all positions with the same material.
+static uint64_t materialKey(const int (&count)[12])
+{
+	uint64_t key = 0;
+	for (int piece = 0; piece < 12; piece++)
+		for (int i = 0; i < count[piece]; i++)
+			key ^= Zobrist::KEYS.piece[piece][i];
+	return key;
+}
+
+
+static uint64_t materialKey(const Board &board)
+{
+	int count[12];
+	for (int piece = 0; piece < 12; piece++)
+		count[piece] = (int)bitcount(board.bitboard[piece]);
+	return materialKey(count);
+}
+
+// Fills the index tables. They do not depend on the tables found, so this is only done once.
+static void initIndexTables()
+{
+	int code = 0;
+	for (int s = 0; s < 64; s++)
+		if (offA1H8(s) < 0)
+			MapB1H1H7[s] = code++;
+
+	// Squares of the a1-d1-d4 triangle, the ones on the diagonal last.
+	std::vector<int> diagonal;
+	code = 0;
+	for (int s = 0; s <= 27; s++)
+	{
+		if (offA1H8(s) < 0 && fileOf(s) <= 3)
+			MapA1D1D4[s] = code++;
+		else if (offA1H8(s) == 0 && fileOf(s) <= 3)
+			diagonal.push_back(s);
+	}
+	for (const int s : diagonal)
+		MapA1D1D4[s] = code++;
+
+	// The 462 legal placements of two kings with the first in the a1-d1-d4 triangle. If the first king is on the
+	// diagonal, the second may not be above it. Placements with both kings on the diagonal come last.
+	std::vector<std::pair<int, int>> bothOnDiagonal;
+	code = 0;
+	for (int idx = 0; idx < 10; idx++)
+	{
+		for (int s1 = 0; s1 <= 27; s1++)
+		{
+			if (MapA1D1D4[s1] != idx || (idx == 0 && s1 != 1))
+				continue;
+
+			for (int s2 = 0; s2 < 64; s2++)
+			{
+				if (s1 == s2 || (std::abs(fileOf(s1) - fileOf(s2)) <= 1 && std::abs(rankOf(s1) - rankOf(s2)) <= 1))
+					continue;
+				else if (offA1H8(s1) == 0 && offA1H8(s2) > 0)
+					continue;
+				else if (offA1H8(s1) == 0 && offA1H8(s2) == 0)
+					bothOnDiagonal.emplace_back(idx, s2);
+				else
+					MapKK[idx][s2] = code++;
+			}
+		}
+	}
+	for (const auto &p : bothOnDiagonal)
+		MapKK[p.first][p.second] = code++;
+
+	Binomial[0][0] = 1;
+	for (int n = 1; n < 64; n++)
+		for (int k = 0; k < 6 && k <= n; k++)
+			Binomial[k][n] = (k > 0 ? Binomial[k - 1][n - 1] : 0) + (k < n ? Binomial[k][n - 1] : 0);
+
+	// MapPawns numbers the squares a2-h7 so that the leading pawn, nearest to the edge and then lowest, has the
+	// highest number, which is also the number of squares left for the other pawns.
+	int availableSquares = 47;
+	for (int leadPawnsCnt = 1; leadPawnsCnt <= 5; leadPawnsCnt++)
+	{
+		for (int f = 0; f <= 3; f++)
+		{
+			int idx = 0;
+			for (int r = 1; r <= 6; r++)
+			{
+				const int sq = r * 8 + f;
+				if (leadPawnsCnt == 1)
+				{
+					MapPawns[sq] = availableSquares--;
+					MapPawns[sq ^ 7] = availableSquares--;
+				}
+				LeadPawnIdx[leadPawnsCnt][sq] = idx;
+				idx += Binomial[leadPawnsCnt - 1][MapPawns[sq]];
+			}
+			LeadPawnsSize[leadPawnsCnt][f] = idx;
+		}
+	}
+}
+
+// Registers the table of the given piece counts (first side, second side, by piece type) if its WDL file exists.
+static void addTable(const int (&first)[6], const int (&second)[6])
+{
+	int count[12];
+	std::string name;
+
+	for (int side = 0; side < 2; side++)
+	{
+		const int (&pieces)[6] = side == 0 ? first : second;
+		if (side == 1)
+			name += 'v';
+		for (const piece_t type : NAME_ORDER)
+			name += std::string(pieces[type], NAME_LETTER[type]);
+		for (piece_t type = Board::PAWN; type <= Board::KING; type++)
+			count[side * Board::BLACK + type] = pieces[type];
+	}
+
+	const uint64_t key = materialKey(count);
+	if (tableIndex.count(key))
+		return;
+
+	bool found = false;
+	for (const std::string &directory : directories)
+	{
+		if (std::ifstream(directory + "/" + name + ".rtbw"))
+		{
+			found = true;
+			break;
+		}
+	}
+	if (!found)
+		return;
+
+	int swapped[12];
+	for (int piece = 0; piece < 12; piece++)
+		swapped[piece] = count[(piece + Board::BLACK) % 12];
+
+	std::unique_ptr<Table> table(new Table());
+	table->name = name;
+	table->key = key;
+	table->key2 = materialKey(swapped);
+	table->pieceCount = 0;
+	table->hasPawns = first[Board::PAWN] + second[Board::PAWN] > 0;
+	table->hasUniquePieces = false;
+
+	for (int piece = 0; piece < 12; piece++)
+	{
+		table->pieceCount += count[piece];
+		if (piece % Board::BLACK != Board::KING && count[piece] == 1)
+			table->hasUniquePieces = true;
+	}
+
+	// The leading color is the one with fewer pawns, unless it has none.
+	const bool firstLeads = second[Board::PAWN] == 0 || (first[Board::PAWN] > 0 && second[Board::PAWN] >= first[Board::PAWN]);
+	table->pawnCount[0] = firstLeads ? first[Board::PAWN] : second[Board::PAWN];
+	table->pawnCount[1] = firstLeads ? second[Board::PAWN] : first[Board::PAWN];
+
+	tableIndex[table->key] = table.get();
+	tableIndex[table->key2] = table.get();
+	tables.push_back(std::move(table));
+}
+
+// Calls addTable for all piece sets of one side with the given number of pieces besides the king, and for each
+// of them all sets of the other side. Pieces are added from the strongest down, starting at NAME_ORDER[first], so
+// that every set is produced once.
+static void addTables(int (&white)[6], int (&black)[6], const int side, const int remaining, const int first, const int blackCount)
+{
+	if (remaining == 0)
+	{
+		if (side == 0)
+			addTables(white, black, 1, blackCount, 1, 0);
+		else
+			addTable(white, black);
+		return;
+	}
+
+	int (&pieces)[6] = side == 0 ? white : black;
+
+	for (int i = first; i < 6; i++)
+	{
+		pieces[NAME_ORDER[i]]++;
+		addTables(white, black, side, remaining - 1, i, blackCount);
+		pieces[NAME_ORDER[i]]--;
+	}
+}
+
+// Looks up the tables in the directories of the path, separated by ';' on Windows and ':' elsewhere, and returns
+// the number of tables found. The files are only opened when a table is first probed.
+unsigned int Syzygy::init(const std::string &path)
+{
+	static bool indexTablesReady = false;
+	if (!indexTablesReady)
+	{
+		initIndexTables();
+		indexTablesReady = true;
+	}
+
+	tables.clear();
+	tableIndex.clear();
+	directories.clear();
+	largest = 0;
+
+	std::istringstream stream(path);
+	std::string directory;
+	while (std::getline(stream, directory, PATH_SEPARATOR))
+	{
+		if (!directory.empty())
+			directories.push_back(directory);
+	}
+
+	if (directories.empty())
+		return 0;
+
+	// Every split of up to MAX_PIECES - 2 pieces besides the kings between the two sides.
+	for (int total = 1; total <= (int)MAX_PIECES - 2; total++)
+	{
+		for (int firstCount = total; firstCount >= 0; firstCount--)
+		{
+			int first[6] = { 0, 0, 0, 0, 0, 1 };
+			int second[6] = { 0, 0, 0, 0, 0, 1 };
+			const size_t before = tables.size();
+			addTables(first, second, 0, firstCount, 1, total - firstCount);
+
+			for (size_t i = before; i < tables.size(); i++)
+				largest = std::max(largest, (unsigned int)tables[i]->pieceCount);
+		}
+	}
+
+	return (unsigned int)tables.size();
+}
+
+// Limits probing to positions with at most the given number of pieces.
+void Syzygy::setProbeLimit(const unsigned int pieces)
+{
+	probeLimit = std::min(pieces, MAX_PIECES);
+}
+
+// Largest number of pieces of the positions to probe, 0 if there are no tables.
+unsigned int Syzygy::cardinality()
+{
+	return std::min(largest, probeLimit);
+}
+
+// Sets the groups of pieces that are encoded together and the index factor of every group.
+static void setGroups(const Table &table, PairsData &d, const int (&order)[2], const int f)
+{
+	int n = 0;
+	int firstLen = table.hasPawns ? 0 : table.hasUniquePieces ? 3 : 2;
+	d.groupLen[n] = 1;
+
+	// The leading group holds the kings, or three unique pieces, or the leading pawns. Equal pieces that follow
+	// each other form the other groups.
+	for (int i = 1; i < table.pieceCount; i++)
+	{
+		if (--firstLen > 0 || d.pieces[i] == d.pieces[i - 1])
+			d.groupLen[n]++;
+		else
+			d.groupLen[++n] = 1;
+	}
+	d.groupLen[++n] = 0;
+
+	// The index is a mixed radix number of the group indices, in the order given by the table.
+	const bool pp = table.hasPawns && table.pawnCount[1] > 0;
+	int next = pp ? 2 : 1;
+	int freeSquares = 64 - d.groupLen[0] - (pp ? d.groupLen[1] : 0);
+	uint64_t idx = 1;
+
+	for (int k = 0; next < n || k == order[0] || k == order[1]; k++)
+	{
+		if (k == order[0])
+		{
+			d.groupIdx[0] = idx;
+			idx *= table.hasPawns ? LeadPawnsSize[d.groupLen[0]][f] : table.hasUniquePieces ? 31332 : 462;
+		}
+		else if (k == order[1])
+		{
+			d.groupIdx[1] = idx;
+			idx *= Binomial[d.groupLen[1]][48 - d.groupLen[0]];
+		}
+		else
+		{
+			d.groupIdx[next] = idx;
+			idx *= Binomial[d.groupLen[next]][freeSquares];
+			freeSquares -= d.groupLen[next++];
+		}
+	}
+
+	d.groupIdx[n] = idx;
+}
+
+// Number of values a symbol expands to, minus one. Pair symbols expand to both of their symbols.
+static int setSymlen(PairsData &d, const uint16_t sym, std::vector<bool> &visited)
+{
+	visited[sym] = true;
+	const uint16_t right = rightSymbol(d, sym);
+
+	if (right == 0xFFF)
+		return 0;
+
+	const uint16_t left = leftSymbol(d, sym);
+
+	if (!visited[left])
+		d.symlen[left] = (uint8_t)setSymlen(d, left, visited);
+
+	if (!visited[right])
+		d.symlen[right] = (uint8_t)setSymlen(d, right, visited);
+
+	return d.symlen[left] + d.symlen[right] + 1;
+}
+
+// Reads the compression parameters of a PairsData and returns the data following them.
+static const uint8_t *setSizes(PairsData &d, const uint8_t *data)
+{
+	d.flags = *data++;
+
+	if (d.flags & FLAG_SINGLE_VALUE)
+	{
+		d.numBlocks = 0;
+		d.span = 0;
+		d.blockLengthSize = 0;
+		d.sparseIndexSize = 0;
+		d.minSymLen = *data++;
+		return data;
+	}
+
+	const uint64_t tbSize = d.groupIdx[std::find(d.groupLen, d.groupLen + Syzygy::MAX_PIECES, 0) - d.groupLen];
+
+	d.sizeofBlock = (size_t)1 << *data++;
+	d.span = (size_t)1 << *data++;
+	d.sparseIndexSize = (size_t)((tbSize + d.span - 1) / d.span);
+	const uint8_t padding = *data++;
+	d.numBlocks = readLittleEndian32(data);
+	data += 4;
+	d.blockLengthSize = d.numBlocks + padding;
+	d.maxSymLen = *data++;
+	d.minSymLen = *data++;
+	d.lowestSym = data;
+	d.base64.assign(d.maxSymLen - d.minSymLen + 1, 0);
+
+	// Canonical Huffman codes: longer codes have lower values. base64[l] is the lowest code of length
+	// l + minSymLen, left aligned, so the length of a code is found by comparing with base64.
+	for (int i = (int)d.base64.size() - 2; i >= 0; i--)
+	{
+		d.base64[i] = (d.base64[i + 1] + readLittleEndian16(d.lowestSym + 2 * i) - readLittleEndian16(d.lowestSym + 2 * (i + 1))) / 2;
+	}
+
+	for (size_t i = 0; i < d.base64.size(); i++)
+	{
+		d.base64[i] <<= 64 - i - d.minSymLen;
+	}
+
+	data += d.base64.size() * 2;
+	d.symlen.assign(readLittleEndian16(data), 0);
+	data += 2;
+	d.btree = data;
+
+	std::vector<bool> visited(d.symlen.size());
+	for (uint16_t sym = 0; sym < d.symlen.size(); sym++)
+	{
+		if (!visited[sym])
+			d.symlen[sym] = (uint8_t)setSymlen(d, sym, visited);
+	}
+
+	return data + d.symlen.size() * 3 + (d.symlen.size() & 1);
+}
+
+// Reads the value maps of a DTZ table, which translate the stored values by the WDL result.
+static const uint8_t *setDtzMap(TableFile &file, const uint8_t *data, const int maxFile)
+{
+	file.map = data;
+
+	for (int f = 0; f <= maxFile; f++)
+	{
+		PairsData &d = file.items[0][f];
+
+		if (d.flags & FLAG_MAPPED)
+		{
+			if (d.flags & FLAG_WIDE)
+			{
+				data += (uintptr_t)data & 1;
+				for (int i = 0; i < 4; i++)
+				{
+					d.mapIdx[i] = (uint16_t)((data - file.map) / 2 + 1);
+					data += 2 * readLittleEndian16(data) + 2;
+				}
+			}
+			else
+			{
+				for (int i = 0; i < 4; i++)
+				{
+					d.mapIdx[i] = (uint16_t)(data - file.map + 1);
+					data += *data + 1;
+				}
+			}
+		}
+	}
+
+	return data + ((uintptr_t)data & 1);
+}
+
+// Reads the header of a mapped table file, data points behind the magic number.
+static void setup(const Table &table, TableFile &file, const bool dtz, const uint8_t *data)
+{
+	const int sides = !dtz && table.key != table.key2 ? 2 : 1;
+	const int maxFile = table.hasPawns ? 3 : 0;
+	const bool pp = table.hasPawns && table.pawnCount[1] > 0;
+
+	data++;		// flags
+
+	for (int f = 0; f <= maxFile; f++)
+	{
+		const int order[2][2] =
+		{
+			{ data[0] & 0xF, pp ? data[1] & 0xF : 0xF },
+			{ data[0] >> 4, pp ? data[1] >> 4 : 0xF }
+		};
+		data += 1 + pp;
+
+		for (int k = 0; k < table.pieceCount; k++, data++)
+			for (int i = 0; i < sides; i++)
+				file.items[i][f].pieces[k] = i ? *data >> 4 : *data & 0xF;
+
+		for (int i = 0; i < sides; i++)
+			setGroups(table, file.items[i][f], order[i], f);
+	}
+
+	data += (uintptr_t)data & 1;
+
+	for (int f = 0; f <= maxFile; f++)
+		for (int i = 0; i < sides; i++)
+			data = setSizes(file.items[i][f], data);
+
+	if (dtz)
+		data = setDtzMap(file, data, maxFile);
+
+	for (int f = 0; f <= maxFile; f++)
+	{
+		for (int i = 0; i < sides; i++)
+		{
+			file.items[i][f].sparseIndex = data;
+			data += file.items[i][f].sparseIndexSize * 6;
+		}
+	}
+
+	for (int f = 0; f <= maxFile; f++)
+	{
+		for (int i = 0; i < sides; i++)
+		{
+			file.items[i][f].blockLength = data;
+			data += file.items[i][f].blockLengthSize * 2;
+		}
+	}
+
+	for (int f = 0; f <= maxFile; f++)
+	{
+		for (int i = 0; i < sides; i++)
+		{
+			data = (const uint8_t *)(((uintptr_t)data + 0x3F) & ~(uintptr_t)0x3F);
+			file.items[i][f].data = data;
+			data += file.items[i][f].numBlocks * file.items[i][f].sizeofBlock;
+		}
+	}
+}
+
+// Maps a table file on its first use. Returns false if it is missing or invalid.
+static bool mapTable(const Table &table, TableFile &file, const bool dtz)
+{
+	if (file.ready.load(std::memory_order_acquire))
+		return file.valid;
+
+	std::lock_guard<std::mutex> lock(mappingMutex);
+
+	if (file.ready.load(std::memory_order_relaxed))
+		return file.valid;
+
+	const std::string name = table.name + (dtz ? ".rtbz" : ".rtbw");
+	for (const std::string &directory : directories)
+	{
+		if (file.file.open(directory + "/" + name))
+			break;
+	}
+
+	// Valid files consist of the 16 bytes header and 64 byte blocks.
+	if (file.file.isOpen() && file.file.size() % 64 == 16 && std::memcmp(file.file.data(), dtz ? DTZ_MAGIC : WDL_MAGIC, 4) == 0)
+	{
+		setup(table, file, dtz, file.file.data() + 4);
+		file.valid = true;
+	}
+	else
+	{
+		file.file.close();
+	}
+
+	file.ready.store(true, std::memory_order_release);
+	return file.valid;
+}
+
+// Value at an index of a PairsData.
+static int decompressPairs(const PairsData &d, const uint64_t idx)
+{
+	if (d.flags & FLAG_SINGLE_VALUE)
+		return d.minSymLen;
+
+	// The sparse index gives the block and offset of the value in the middle of every span, the block of the value
+	// is found by walking the block lengths from there.
+	const uint32_t k = (uint32_t)(idx / d.span);
+	uint32_t block = readLittleEndian32(d.sparseIndex + 6 * k);
+	int offset = readLittleEndian16(d.sparseIndex + 6 * k + 4);
+
+	offset += (int)(idx % d.span) - (int)(d.span / 2);
+
+	while (offset < 0)
+		offset += readLittleEndian16(d.blockLength + 2 * --block) + 1;
+
+	while (offset > readLittleEndian16(d.blockLength + 2 * block))
+		offset -= readLittleEndian16(d.blockLength + 2 * block++) + 1;
+
+	// Decode the symbols of the block until the one that covers the offset.
+	const uint8_t *ptr = d.data + (uint64_t)block * d.sizeofBlock;
+	uint64_t buf64 = readBigEndian64(ptr);
+	ptr += 8;
+	int buf64Size = 64;
+	uint16_t sym;
+
+	while (true)
+	{
+		int len = 0;
+
+		while (buf64 < d.base64[len])
+			len++;
+
+		sym = (uint16_t)((buf64 - d.base64[len]) >> (64 - len - d.minSymLen));
+		sym += readLittleEndian16(d.lowestSym + 2 * len);
+
+		if (offset < d.symlen[sym] + 1)
+			break;
+
+		offset -= d.symlen[sym] + 1;
+		len += d.minSymLen;
+		buf64 <<= len;
+		buf64Size -= len;
+
+		if (buf64Size <= 32)
+		{
+			buf64Size += 32;
+			buf64 |= (uint64_t)readBigEndian32(ptr) << (64 - buf64Size);
+			ptr += 4;
+		}
+	}
+
+	// Expand the pair symbol down to the value at the offset.
+	while (d.symlen[sym])
+	{
+		const uint16_t left = leftSymbol(d, sym);
+
+		if (offset < d.symlen[left] + 1)
+		{
+			sym = left;
+		}
+		else
+		{
+			offset -= d.symlen[left] + 1;
+			sym = rightSymbol(d, sym);
+		}
+	}
+
+	return leftSymbol(d, sym);
+}
+
+// Converts a stored DTZ value to plies.
+static int mapDtzScore(const TableFile &file, const int f, int value, const int wdl)
+{
+	static const int WDL_MAP[5] = { 1, 3, 0, 2, 0 };
+	const PairsData &d = file.items[0][f];
+
+	if (d.flags & FLAG_MAPPED)
+	{
+		if (d.flags & FLAG_WIDE)
+			value = readLittleEndian16(file.map + 2 * (d.mapIdx[WDL_MAP[wdl + 2]] + value));
+		else
+			value = file.map[d.mapIdx[WDL_MAP[wdl + 2]] + value];
+	}
+
+	// Values are stored in moves unless the table says plies.
+	if ((wdl == Syzygy::WIN && !(d.flags & FLAG_WIN_PLIES))
+		|| (wdl == Syzygy::LOSS && !(d.flags & FLAG_LOSS_PLIES))
+		|| wdl == Syzygy::CURSED_WIN
+		|| wdl == Syzygy::BLESSED_LOSS)
+	{
+		value *= 2;
+	}
+
+	return value + 1;
+}
+
+// Value of the position in the WDL or DTZ table of its material. For DTZ, wdl is the result of the position.
+static int probeTable(const Board &board, const color turn, const bool dtz, const int wdl, ProbeState &state)
+{
+	if (board.positionMask() == (board.bitboard[Board::WHITE + Board::KING] | board.bitboard[Board::BLACK + Board::KING]))
+		return Syzygy::DRAW;
+
+	const uint64_t key = materialKey(board);
+	const auto found = tableIndex.find(key);
+
+	if (found == tableIndex.end())
+	{
+		state = FAIL;
+		return 0;
+	}
+
+	const Table &table = *found->second;
+	TableFile &file = dtz ? found->second->dtz : found->second->wdl;
+
+	if (!mapTable(table, file, dtz))
+	{
+		state = FAIL;
+		return 0;
+	}
+
+	int squares[Syzygy::MAX_PIECES];
+	uint8_t pieces[Syzygy::MAX_PIECES];
+	int size = 0;
+	int leadPawnsCnt = 0;
+	uint64_t leadPawns = 0;
+	int tbFile = 0;
+
+	// Tables store the stronger side, the first of the name, as white. Symmetric tables only store white to move.
+	// Otherwise colors are swapped and the board is mirrored vertically.
+	const bool flip = (table.key == table.key2 && turn == Board::BLACK) || key != table.key;
+	const int flipColor = flip ? 8 : 0;
+	const int flipSquares = flip ? 56 : 0;
+	const int stm = (flip ? 1 : 0) ^ (turn == Board::BLACK ? 1 : 0);
+
+	// Tables with pawns are split by the file of the leading pawn, the one with the highest MapPawns value.
+	if (table.hasPawns)
+	{
+		const uint8_t leadPiece = file.items[0][0].pieces[0] ^ flipColor;
+		uint64_t mask = leadPawns = board.bitboard[(leadPiece & 8 ? Board::BLACK : Board::WHITE) + Board::PAWN];
+
+		while (mask)
+			squares[size++] = popLSB(mask) ^ flipSquares;
+
+		leadPawnsCnt = size;
+		std::swap(squares[0], *std::max_element(squares, squares + leadPawnsCnt, pawnsCompare));
+		tbFile = std::min(fileOf(squares[0]), 7 - fileOf(squares[0]));
+	}
+
+	// DTZ tables only store one side to move.
+	if (dtz && (file.items[0][tbFile].flags & FLAG_STM) != stm && !(table.key == table.key2 && !table.hasPawns))
+	{
+		state = CHANGE_STM;
+		return 0;
+	}
+
+	uint64_t mask = board.positionMask() ^ leadPawns;
+	while (mask)
+	{
+		const piece_p pos = popLSB(mask);
+		squares[size] = pos ^ flipSquares;
+		pieces[size++] = TB_PIECE[board.pieceAt(pos)] ^ flipColor;
+	}
+
+	const PairsData &d = file.items[dtz ? 0 : stm][tbFile];
+
+	// Order the pieces like the table does.
+	for (int i = leadPawnsCnt; i < size - 1; i++)
+	{
+		for (int j = i + 1; j < size; j++)
+		{
+			if (d.pieces[i] == pieces[j])
+			{
+				std::swap(pieces[i], pieces[j]);
+				std::swap(squares[i], squares[j]);
+				break;
+			}
+		}
+	}
+
+	// Mirror horizontally so that the leading piece is on files a-d.
+	if (fileOf(squares[0]) > 3)
+		for (int i = 0; i < size; i++)
+			squares[i] ^= 7;
+
+	uint64_t idx;
+
+	if (table.hasPawns)
+	{
+		idx = LeadPawnIdx[leadPawnsCnt][squares[0]];
+		std::stable_sort(squares + 1, squares + leadPawnsCnt, pawnsCompare);
+
+		for (int i = 1; i < leadPawnsCnt; i++)
+			idx += Binomial[i][MapPawns[squares[i]]];
+	}
+	else
+	{
+		// Without pawns, also mirror vertically so that the leading piece is on ranks 1-4, and along the a1-h8
+		// diagonal so that the first piece of the leading group off the diagonal is below it.
+		if (rankOf(squares[0]) > 3)
+			for (int i = 0; i < size; i++)
+				squares[i] ^= 56;
+
+		for (int i = 0; i < d.groupLen[0]; i++)
+		{
+			if (!offA1H8(squares[i]))
+				continue;
+
+			if (offA1H8(squares[i]) > 0)
+				for (int j = i; j < size; j++)
+					squares[j] = ((squares[j] >> 3) | (squares[j] << 3)) & 63;
+			break;
+		}
+
+		if (table.hasUniquePieces)
+		{
+			// Three unique pieces are encoded together, the later ones skipping the squares of the earlier ones.
+			const int adjust1 = squares[1] > squares[0];
+			const int adjust2 = (squares[2] > squares[0]) + (squares[2] > squares[1]);
+
+			if (offA1H8(squares[0]))
+				idx = ((uint64_t)MapA1D1D4[squares[0]] * 63 + (squares[1] - adjust1)) * 62 + squares[2] - adjust2;
+			else if (offA1H8(squares[1]))
+				idx = ((uint64_t)6 * 63 + rankOf(squares[0]) * 28 + MapB1H1H7[squares[1]]) * 62 + squares[2] - adjust2;
+			else if (offA1H8(squares[2]))
+				idx = 6 * 63 * 62 + 4 * 28 * 62 + rankOf(squares[0]) * 7 * 28 + (rankOf(squares[1]) - adjust1) * 28 + MapB1H1H7[squares[2]];
+			else
+				idx = 6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28 + rankOf(squares[0]) * 7 * 6 + (rankOf(squares[1]) - adjust1) * 6 + (rankOf(squares[2]) - adjust2);
+		}
+		else
+		{
+			idx = MapKK[MapA1D1D4[squares[0]]][squares[1]];
+		}
+	}
+
+	// The other groups are encoded as combinations of the squares not taken by the earlier groups.
+	idx *= d.groupIdx[0];
+	int *groupSq = squares + d.groupLen[0];
+	bool remainingPawns = table.hasPawns && table.pawnCount[1] > 0;
+
+	for (int next = 1; d.groupLen[next]; next++)
+	{
+		std::stable_sort(groupSq, groupSq + d.groupLen[next]);
+		uint64_t n = 0;
+
+		for (int i = 0; i < d.groupLen[next]; i++)
+		{
+			const int sq = groupSq[i];
+			const int adjust = (int)std::count_if(squares, groupSq, [sq](const int s) { return sq > s; });
+			n += Binomial[i + 1][sq - adjust - 8 * remainingPawns];
+		}
+
+		remainingPawns = false;
+		idx += n * d.groupIdx[next];
+		groupSq += d.groupLen[next];
+	}
+
+	const int value = decompressPairs(d, idx);
+	return dtz ? mapDtzScore(file, tbFile, value, wdl) : value - 2;
+}
+
+static inline bool isCapture(const Board &board, const Move &move)
+{
+	return board.pieceAt(move.dest()) != Board::EMPTY || move.kind() == Move::EN_PASSANT;
+}
+
+// WDL of a position. Captures (and pawn moves if checkZeroingMoves) are searched first, because the tables
+// do not account for en passant and may store "don't care" values where a capture is best.
+static int searchWdl(Board &board, const color turn, const bool checkZeroingMoves, ProbeState &state)
+{
+	MoveList moves;
+	MoveGenerator::generateMoves(board, turn, moves);
+
+	int bestValue = Syzygy::LOSS;
+	unsigned int moveCount = 0;
+
+	for (const Move &move : moves)
+	{
+		if (!isCapture(board, move) && (!checkZeroingMoves || board.pieceType(move.pos()) != Board::PAWN))
+			continue;
+
+		moveCount++;
+
+		board.makeMove(move, turn);
+		const int value = -searchWdl(board, turn ^ Board::BLACK, false, state);
+		board.unmakeMove();
+
+		if (state == FAIL)
+			return Syzygy::DRAW;
+
+		if (value > bestValue)
+		{
+			bestValue = value;
+
+			if (value >= Syzygy::WIN)
+			{
+				state = ZEROING_BEST_MOVE;
+				return value;
+			}
+		}
+	}
+
+	// If all moves were searched, the table is not needed.
+	const bool noMoreMoves = moveCount > 0 && moveCount == moves.size;
+	int value;
+
+	if (noMoreMoves)
+	{
+		value = bestValue;
+	}
+	else
+	{
+		value = probeTable(board, turn, false, Syzygy::DRAW, state);
+		if (state == FAIL)
+			return Syzygy::DRAW;
+	}
+
+	if (bestValue >= value)
+	{
+		state = bestValue > Syzygy::DRAW || noMoreMoves ? ZEROING_BEST_MOVE : OK;
+		return bestValue;
+	}
+
+	state = OK;
+	return value;
+}
+
+// DTZ of a position whose best move is a zeroing move of the given result.
+static int dtzBeforeZeroing(const int wdl)
+{
+	return wdl == Syzygy::WIN ? 1
+		: wdl == Syzygy::CURSED_WIN ? 101
+		: wdl == Syzygy::BLESSED_LOSS ? -101
+		: wdl == Syzygy::LOSS ? -1
+		: 0;
+}
+
+static inline int signOf(const int value)
+{
+	return (value > 0) - (value < 0);
+}
+
+// DTZ of a position in plies, positive if the side to move wins. Cursed wins and blessed losses are beyond 100.
+static int searchDtz(Board &board, const color turn, ProbeState &state)
+{
+	const int wdl = searchWdl(board, turn, true, state);
+
+	if (state == FAIL || wdl == Syzygy::DRAW)
+		return 0;
+
+	if (state == ZEROING_BEST_MOVE)
+		return dtzBeforeZeroing(wdl);
+
+	int dtz = probeTable(board, turn, true, wdl, state);
+
+	if (state == FAIL)
+		return 0;
+
+	if (state != CHANGE_STM)
+		return (dtz + 100 * (wdl == Syzygy::BLESSED_LOSS || wdl == Syzygy::CURSED_WIN)) * signOf(wdl);
+
+	// The table stores the other side to move: take the best DTZ after one move.
+	MoveList moves;
+	MoveGenerator::generateMoves(board, turn, moves);
+	int minDtz = 0xFFFF;
+
+	for (const Move &move : moves)
+	{
+		const bool zeroing = isCapture(board, move) || board.pieceType(move.pos()) == Board::PAWN;
+
+		board.makeMove(move, turn);
+
+		// For zeroing moves the DTZ before the move is wanted, from the result after it.
+		dtz = zeroing ? -dtzBeforeZeroing(searchWdl(board, turn ^ Board::BLACK, false, state))
+			: -searchDtz(board, turn ^ Board::BLACK, state);
+
+		// A mating move has DTZ 1.
+		if (dtz == 1 && board.isKingCheck(turn ^ Board::BLACK))
+		{
+			MoveList replies;
+			MoveGenerator::generateMoves(board, turn ^ Board::BLACK, replies);
+			if (replies.size == 0)
+				minDtz = 1;
+		}
+
+		if (!zeroing)
+			dtz += signOf(dtz);
+
+		if (dtz < minDtz && signOf(dtz) == signOf(wdl))
+			minDtz = dtz;
+
+		board.unmakeMove();
+
+		if (state == FAIL)
+			return 0;
+	}
+
+	return minDtz == 0xFFFF ? -1 : minDtz;
+}
+
+// True if the position can be probed: it has no castling rights and not too many pieces.
+static inline bool probeable(const Board &board)
+{
+	return board.castlingRights() == 0 && bitcount(board.positionMask()) <= Syzygy::cardinality();
+}
+
+// WDL result of a position, relative to the side to move. Returns false if the position cannot be probed.
+bool Syzygy::probeWdl(Board &board, const color turn, int &wdl)
+{
+	if (!probeable(board))
+		return false;
+
+	ProbeState state = OK;
+	wdl = searchWdl(board, turn, false, state);
+	return state != FAIL;
+}
+
+// DTZ of a position in plies, relative to the side to move. Returns false if the position cannot be probed.
+bool Syzygy::probeDtz(Board &board, const color turn, int &dtz)
+{
+	if (!probeable(board))
+		return false;
+
+	ProbeState state = OK;
+	dtz = searchDtz(board, turn, state);
+	return state != FAIL;
+}
+
+// Picks the root move that keeps the best result: a win with the shortest distance to zeroing, or a loss with the
+// longest, which also makes progress towards the end. Sets the result and DTZ of the root position.
+// The halfmove clock decides whether the fifty-move rule draws the game first: a win whose zeroing move comes too
+// late only ranks above draws, as a cursed win, and a loss the opponent cannot convert in time as a blessed loss.
+bool Syzygy::probeRoot(Board &board, const color turn, Move &move, int &wdl, int &dtz)
+{
+	if (!probeable(board))
+		return false;
+
+	const int halfmoves = board.halfmoveClock();
+	MoveList moves;
+	MoveGenerator::generateMoves(board, turn, moves);
+	int bestRank = INT_MIN;
+
+	for (const Move &candidate : moves)
+	{
+		const bool zeroing = isCapture(board, candidate) || board.pieceType(candidate.pos()) == Board::PAWN;
+		const color enemy = turn ^ Board::BLACK;
+		ProbeState state = OK;
+		int moveDtz;
+
+		board.makeMove(candidate, turn);
+
+		if (zeroing)
+		{
+			moveDtz = dtzBeforeZeroing(-searchWdl(board, enemy, false, state));
+		}
+		else
+		{
+			moveDtz = -searchDtz(board, enemy, state);
+			moveDtz += signOf(moveDtz);
+		}
+
+		// A mating move has DTZ 1.
+		if (moveDtz == 2 && board.isKingCheck(enemy))
+		{
+			MoveList replies;
+			MoveGenerator::generateMoves(board, enemy, replies);
+			if (replies.size == 0)
+				moveDtz = 1;
+		}
+
+		board.unmakeMove();
+
+		if (state == FAIL)
+			return false;
+
+		// Wins rank above draws above losses. Shorter wins and longer losses are better, and so are wins and losses
+		// closer to the fifty-move limit among those it decides.
+		const int rank = moveDtz > 0 ? (moveDtz + halfmoves <= 99 ? 200000 - moveDtz : 100000 - (moveDtz + halfmoves))
+			: moveDtz < 0 ? (-moveDtz * 2 + halfmoves < 100 ? -200000 - moveDtz : -100000 + (-moveDtz + halfmoves))
+			: 0;
+
+		if (rank > bestRank)
+		{
+			bestRank = rank;
+			move = candidate;
+			dtz = moveDtz;
+		}
+	}
+
+	if (moves.size == 0)
+		return false;
+
+	wdl = bestRank > 150000 ? WIN : bestRank > 0 ? CURSED_WIN : bestRank == 0 ? DRAW : bestRank > -150000 ? BLESSED_LOSS : LOSS;
+	return true;
+}
+
+// Probes the suite positions and compares the results with the known ones. Syzygy may store a DTZ rounded one ply
+// away from zero, which also matches. Positions whose tables are not found are skipped.
+// Returns true if all probed results match and at least one position was probed.
+bool Syzygy::runSuite(std::ostream &out)
+{
+	unsigned int probed = 0;
+	bool passed = true;
+
+	for (unsigned int i = 0; i < SUITE_SIZE; i++)
+	{
+		const Position &position = SUITE[i];
+		color turn;
+		Board board = UCI::createBoardFromFen(position.fen, turn);
+
+		out << "Position " << i + 1 << ": " << position.fen << std::endl;
+
+		int wdl, dtz, rootWdl, rootDtz;
+		Move move;
+		if (!probeWdl(board, turn, wdl) || !probeDtz(board, turn, dtz) || !probeRoot(board, turn, move, rootWdl, rootDtz))
+		{
+			out << "  skipped, table not found" << std::endl;
+			continue;
+		}
+
+		const bool match = wdl == position.wdl
+			&& (dtz == position.dtz || dtz == position.dtz + signOf(position.dtz))
+			&& rootWdl == position.rootWdl;
+
+		out << "  wdl " << wdl << ", dtz " << dtz << ", root wdl " << rootWdl << (match ? " ok" : " FAILED, expected ");
+		if (!match)
+			out << position.wdl << ", " << position.dtz << ", " << position.rootWdl;
+		out << std::endl;
+
+		probed++;
+		passed &= match;
+	}
+
+	passed &= probed > 0;
+	out << std::endl << (probed == 0 ? "No position probed" : passed ? "All results match" : "Some results do not match") << std::endl;
+	return passed;
+}
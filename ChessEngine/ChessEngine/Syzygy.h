@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <ostream>
+#include "Board.h"
+
+namespace chessengine
+{
+
+	// Probing of Syzygy endgame tablebases.
+	// WDL tables (.rtbw) give the result of a position with perfect play, DTZ tables (.rtbz) the distance in plies
+	// to the next capture or pawn move (zeroing move) that keeps that result. Tables are found by name in the
+	// directories of the path when it is set, but only memory mapped when first probed.
+	// Results ignore the fifty-move rule except through the cursed win and blessed loss values, which are wins and
+	// losses that the fifty-move rule turns into draws. Positions with castling rights are not in the tables.
+	class Syzygy
+	{
+
+	public:
+
+		// WDL results, relative to the side to move.
+
+		static const int LOSS = -2;
+		static const int BLESSED_LOSS = -1;
+		static const int DRAW = 0;
+		static const int CURSED_WIN = 1;
+		static const int WIN = 2;
+
+		// Largest number of pieces, kings included, of a table position.
+		static const unsigned int MAX_PIECES = 7;
+
+		static unsigned int init(const std::string &path);
+		static void setProbeLimit(const unsigned int pieces);
+		static unsigned int cardinality();
+
+		static bool probeWdl(Board &board, const color turn, int &wdl);
+		static bool probeDtz(Board &board, const color turn, int &dtz);
+		static bool probeRoot(Board &board, const color turn, Move &move, int &wdl, int &dtz);
+		static bool runSuite(std::ostream &out);
+
+	private:
+
+		// A test position and its known results, relative to the side to move: WDL and DTZ, and the result of the
+		// root probe, which also counts the halfmove clock of the position.
+		struct Position
+		{
+			const char *fen;
+			int wdl;
+			int dtz;
+			int rootWdl;
+		};
+
+		static const unsigned int SUITE_SIZE = 11;
+		static const Position SUITE[SUITE_SIZE];
+
+		static unsigned int largest;	// Pieces of the largest table found.
+		static unsigned int probeLimit;	// Pieces of the largest positions to probe, set by the user.
+
+	};
+
+}
@@ -0,0 +1,95 @@
+#include <algorithm>
+#include "TimeManager.h"
+
+using namespace chessengine;
+
+SearchLimits::SearchLimits()
+	: time{ 0, 0 }, inc{ 0, 0 }, movesToGo(0), moveTime(0), depth(0), nodes(0), infinite(false), ponder(false)
+{
+}
+
+
+bool SearchLimits::timed() const
+{
+	return !infinite && (moveTime > 0 || time[0] > 0 || time[1] > 0);
+}
+
+
+TimeManager::TimeManager()
+	: timed(false), pondering(false), optimumTime(0), maximumTime(0)
+{
+}
+
+// Starts the clock and computes the time allocation of the move.
+void TimeManager::start(const SearchLimits &limits, const color turn)
+{
+	startTime = allocationStart = std::chrono::steady_clock::now();
+	timed = limits.timed();
+	pondering = limits.ponder;
+
+	if (!timed)
+		return;
+
+	if (limits.moveTime > 0)
+	{
+		optimumTime = maximumTime = std::max(limits.moveTime - MOVE_OVERHEAD, 1ll);
+		return;
+	}
+
+	const long long time = limits.time[turn / Board::BLACK];
+	const long long inc = limits.inc[turn / Board::BLACK];
+	const long long available = std::max(time - MOVE_OVERHEAD, 1ll);
+
+	// Spread the remaining time over the moves to the next time control, or over 40 moves in sudden death.
+	const long long movesToGo = limits.movesToGo ? std::min(limits.movesToGo, 40u) : 40;
+
+	optimumTime = std::min(available / movesToGo + inc * 3 / 4, available);
+	maximumTime = std::min(optimumTime * 4, available * 3 / 4);
+	optimumTime = std::min(std::max(optimumTime, 1ll), maximumTime);
+}
+
+// Ends pondering: the opponent played the expected move, and the time allocated to the move starts now. The
+// search keeps its start time, so time spent pondering still counts in its iteration times.
+void TimeManager::ponderhit()
+{
+	pondering = false;
+	allocationStart = std::chrono::steady_clock::now();
+}
+
+// Milliseconds since start.
+long long TimeManager::elapsed() const
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+// Milliseconds of the allocated time used: since start, or since the ponder hit.
+long long TimeManager::allocationElapsed() const
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - allocationStart).count();
+}
+
+// True when the search must be aborted to answer in time.
+bool TimeManager::hardLimitReached() const
+{
+	return timed && !pondering && allocationElapsed() >= maximumTime;
+}
+
+// Predicts whether the next iteration is worth starting. The time of the next iteration is estimated from the
+// growth between the last two iterations; an iteration that would not finish before the hard limit is not started,
+// since the result of an aborted iteration is discarded.
+bool TimeManager::startNextIteration(const long long lastIterationTime, const long long previousIterationTime) const
+{
+	if (!timed || pondering)
+		return true;
+
+	const long long now = allocationElapsed();
+
+	if (now >= optimumTime)
+		return false;
+
+	const double growth = previousIterationTime > 0
+		? std::min(std::max((double)lastIterationTime / previousIterationTime, 1.5), 8.0)
+		: 4.0;
+
+	return now + (long long)(lastIterationTime * growth) <= maximumTime;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <chrono>
+#include "Board.h"
+
+namespace chessengine
+{
+
+	// Limits of a search, as given by the UCI go command. Times are in milliseconds, 0 if not given.
+	struct SearchLimits
+	{
+		long long time[2];		// Remaining time, indexed by color / Board::BLACK.
+		long long inc[2];		// Increment per move, indexed by color / Board::BLACK.
+		unsigned int movesToGo;
+		long long moveTime;
+		unsigned int depth;
+		uint64_t nodes;
+		bool infinite;
+		bool ponder;			// The search starts on the opponent's time, the limits apply from the ponder hit.
+
+		SearchLimits();
+		bool timed() const;
+	};
+
+	// Allocates thinking time for a move and decides when an iterative deepening search should stop.
+	class TimeManager
+	{
+
+	public:
+
+		// Time reserved for communication with the GUI, in milliseconds.
+		static const long long MOVE_OVERHEAD = 30;
+
+		TimeManager();
+
+		void start(const SearchLimits &limits, const color turn);
+		void ponderhit();
+		long long elapsed() const;
+		bool hardLimitReached() const;
+		bool startNextIteration(const long long lastIterationTime, const long long previousIterationTime) const;
+		long long allocationElapsed() const;
+
+		inline bool isPondering() const
+		{
+			return pondering;
+		}
+
+	private:
+
+		std::chrono::steady_clock::time_point startTime;
+		std::chrono::steady_clock::time_point allocationStart;	// Start of the allocated time, the ponder hit when pondering.
+		bool timed;
+		bool pondering;			// No time limit until the ponder hit.
+		long long optimumTime;	// Target time for the move, iterations are not started after this.
+		long long maximumTime;	// The search is aborted after this.
+
+	};
+
+}
@@ -0,0 +1,165 @@
+#include <new>
+#include "TranspositionTable.h"
+
+using namespace chessengine;
+
+TranspositionTable::TranspositionTable(const size_t sizeMB)
+	: memory(nullptr), buckets(nullptr), bucketMask(0), generation(0)
+{
+	resize(sizeMB);
+}
+
+
+TranspositionTable::~TranspositionTable()
+{
+	delete[] memory;
+}
+
+// Reallocates the table with the largest power of two number of buckets that fits in the given size, and clears it.
+void TranspositionTable::resize(const size_t sizeMB)
+{
+	size_t count = 1;
+	while (count * 2 * sizeof(Bucket) <= (sizeMB ? sizeMB : 1) * 1024 * 1024)
+	{
+		count *= 2;
+	}
+
+	delete[] memory;
+	memory = new uint8_t[count * sizeof(Bucket) + 63];
+	buckets = reinterpret_cast<Bucket *>((reinterpret_cast<uintptr_t>(memory) + 63) & ~(uintptr_t)63);
+	bucketMask = count - 1;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		new (&buckets[i]) Bucket();
+	}
+
+	clear();
+}
+
+
+void TranspositionTable::clear()
+{
+	for (size_t i = 0; i <= bucketMask; i++)
+	{
+		for (Slot &slot : buckets[i].slot)
+		{
+			slot.check.store(0, std::memory_order_relaxed);
+			slot.data.store(0, std::memory_order_relaxed);
+		}
+	}
+	generation = 0;
+}
+
+// Ages all stored entries, making them preferred for replacement.
+void TranspositionTable::newSearch()
+{
+	generation = (generation + 1) & 0x3F;
+}
+
+
+bool TranspositionTable::probe(const uint64_t key, Entry &entry) const
+{
+	const Bucket &bucket = buckets[key & bucketMask];
+
+	for (const Slot &slot : bucket.slot)
+	{
+		const uint64_t data = slot.data.load(std::memory_order_relaxed);
+		const uint64_t check = slot.check.load(std::memory_order_relaxed);
+
+		if (data != 0 && (check ^ data) == key)
+		{
+			entry.move = (uint16_t)data;
+			entry.score = (int16_t)(data >> 16);
+			entry.depth = depthOf(data);
+			entry.bound = (uint8_t)(data >> 56) & 0x3;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Stores a search result. An entry of the same position is overwritten, otherwise the entry with the lowest
+// depth, counting entries from earlier searches as shallower, is replaced.
+void TranspositionTable::store(const uint64_t key, const uint16_t move, const int16_t score, const uint8_t depth, const uint8_t bound)
+{
+	Bucket &bucket = buckets[key & bucketMask];
+	Slot *replace = &bucket.slot[0];
+	uint16_t storedMove = move;
+	int worst = INT32_MAX;
+
+	for (Slot &slot : bucket.slot)
+	{
+		const uint64_t data = slot.data.load(std::memory_order_relaxed);
+		const uint64_t check = slot.check.load(std::memory_order_relaxed);
+
+		if (data != 0 && (check ^ data) == key)
+		{
+			// Keep a deeper bound from the current search.
+			if (bound != BOUND_EXACT && generationOf(data) == generation && depth + 2 < depthOf(data))
+				return;
+
+			// Keep the known best move if the new result has none.
+			if (move == 0)
+				storedMove = (uint16_t)data;
+
+			replace = &slot;
+			break;
+		}
+
+		const int age = (generation - generationOf(data)) & 0x3F;
+		const int priority = data == 0 ? INT32_MIN : depthOf(data) - 8 * age;
+
+		if (priority < worst)
+		{
+			worst = priority;
+			replace = &slot;
+		}
+	}
+
+	const uint64_t data = pack(storedMove, score, depth, bound, generation);
+	replace->check.store(key ^ data, std::memory_order_relaxed);
+	replace->data.store(data, std::memory_order_relaxed);
+}
+
+// Permille of the table used by the current search, sampled from the first 1000 entries.
+unsigned int TranspositionTable::hashfull() const
+{
+	const size_t sample = 1000 / ENTRIES_PER_BUCKET;
+	unsigned int used = 0;
+
+	for (size_t i = 0; i < sample && i <= bucketMask; i++)
+	{
+		for (const Slot &slot : buckets[i].slot)
+		{
+			const uint64_t data = slot.data.load(std::memory_order_relaxed);
+			if (data != 0 && generationOf(data) == generation)
+				used++;
+		}
+	}
+
+	return used;
+}
+
+
+uint64_t TranspositionTable::pack(const uint16_t move, const int16_t score, const uint8_t depth, const uint8_t bound, const uint8_t generation)
+{
+	return (uint64_t)move
+		| (uint64_t)(uint16_t)score << 16
+		| (uint64_t)depth << 48
+		| (uint64_t)(bound & 0x3) << 56
+		| (uint64_t)(generation & 0x3F) << 58;
+}
+
+
+uint8_t TranspositionTable::generationOf(const uint64_t data)
+{
+	return (uint8_t)(data >> 58);
+}
+
+
+uint8_t TranspositionTable::depthOf(const uint64_t data)
+{
+	return (uint8_t)(data >> 48);
+}
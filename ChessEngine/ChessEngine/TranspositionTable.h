@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+
+namespace chessengine
+{
+
+	// Hash table of search results shared by all search threads.
+	// Entries are grouped in buckets of one cache line. Access is lock-free: every entry stores its key XORed
+	// with its data, so an entry torn by concurrent writes fails verification instead of being misread.
+	class TranspositionTable
+	{
+
+	public:
+
+		// Bound types
+
+		static const uint8_t BOUND_NONE = 0;
+		static const uint8_t BOUND_EXACT = 1;
+		static const uint8_t BOUND_LOWER = 2;
+		static const uint8_t BOUND_UPPER = 3;
+
+		// Table size
+
+		static const size_t DEFAULT_SIZE_MB = 64;
+		static const unsigned int ENTRIES_PER_BUCKET = 4;
+
+		// Unpacked entry data.
+		struct Entry
+		{
+			uint16_t move;
+			int16_t score;
+			uint8_t depth;
+			uint8_t bound;
+		};
+
+		TranspositionTable(const size_t sizeMB = DEFAULT_SIZE_MB);
+		~TranspositionTable();
+		TranspositionTable(const TranspositionTable &) = delete;
+		TranspositionTable &operator=(const TranspositionTable &) = delete;
+
+		void resize(const size_t sizeMB);
+		void clear();
+		void newSearch();
+		bool probe(const uint64_t key, Entry &entry) const;
+		void store(const uint64_t key, const uint16_t move, const int16_t score, const uint8_t depth, const uint8_t bound);
+		unsigned int hashfull() const;
+
+	private:
+
+		// An entry is two 64-bit words: the key XORed with the data, and the data itself.
+		// Data layout: move (16 bits), score (16), unused (16), depth (8), bound (2), generation (6).
+		struct Slot
+		{
+			std::atomic<uint64_t> check;
+			std::atomic<uint64_t> data;
+		};
+
+		struct alignas(64) Bucket
+		{
+			Slot slot[ENTRIES_PER_BUCKET];
+		};
+
+		uint8_t *memory;		// Allocation, not necessarily aligned.
+		Bucket *buckets;		// Cache line aligned start of the table.
+		size_t bucketMask;		// Number of buckets - 1, the number of buckets is a power of two.
+		uint8_t generation;		// Age of the current search, 6 bits.
+
+		static uint64_t pack(const uint16_t move, const int16_t score, const uint8_t depth, const uint8_t bound, const uint8_t generation);
+		static uint8_t generationOf(const uint64_t data);
+		static uint8_t depthOf(const uint64_t data);
+	};
+
+}
@@ -1,20 +1,32 @@
 #include "UCI.h"
-#include "MoveGenerator.h"
-#include "Node.h"
+#include "ParallelSearch.h"
+#include "Perft.h"
+#include "Nnue.h"
+#include "Syzygy.h"
+#include "Book.h"
+#include "Logger.h"
+#include <algorithm>
 #include <iostream>
-#include <fstream>
+#include <sstream>
+#include <chrono>
 
 using namespace chessengine;
 using namespace std;
 
 UCI::UCI(unsigned int threads, unsigned int depth)
-	: threads(threads), depth(depth)
+	: turnColor(Board::WHITE), threads(threads), depth(depth), stopSearch(false), pondering(false)
 {
+	board.init();
 }
 
 
 UCI::~UCI()
 {
+	stopAndWait();
+
+	for (PawnTable* pawns : pawnTables) {
+		delete pawns;
+	}
 }
 
 
@@ -24,58 +36,328 @@ void UCI::start()
 	srand((unsigned int)time(nullptr));
 
 	string line;
-	ofstream stream;
+	Logger::start("log.txt");
 
 	while (getline(cin, line)) {
 
-		stream.open("log.txt", ios::app);
-		stream << line << endl;
-		stream.close();
+		Logger::write(Logger::INFO, "<< " + line);
 
 		if (line == "uci") {
 			cout << "id name Bogfish" << endl;
 			cout << "id author Bjornar W. Alvestad" << endl;
+			cout << "option name Hash type spin default " << TranspositionTable::DEFAULT_SIZE_MB << " min 1 max 65536" << endl;
+			cout << "option name Threads type spin default " << threads << " min 1 max " << MAX_THREADS << endl;
+			cout << "option name EvalFile type string default <empty>" << endl;
+			cout << "option name UseNNUE type check default true" << endl;
+			cout << "option name SyzygyPath type string default <empty>" << endl;
+			cout << "option name Ponder type check default false" << endl;
+			cout << "option name OwnBook type check default true" << endl;
+			cout << "option name BookFile type string default <empty>" << endl;
+			cout << "option name SyzygyProbeLimit type spin default " << Syzygy::MAX_PIECES << " min 0 max " << Syzygy::MAX_PIECES << endl;
 			cout << "uciok" << endl;
 		}
 		else if (line == "quit") {
+			stopAndWait();
 			break;
 		}
+		else if (line == "stop") {
+			stopAndWait();
+		}
+		else if (line == "ponderhit") {
+			// The search goes on with its table and iterations, now under the time limits of the go command.
+			pondering = false;
+		}
 		else if (line == "isready") {
 			cout << "readyok" << endl;
 		}
+		else if (line == "ucinewgame") {
+			stopAndWait();
+			table.clear();
+			for (PawnTable* pawns : pawnTables) {
+				pawns->clear();
+			}
+			positionStart.clear();
+		}
+		else if (line.substr(0, 15) == "setoption name ") {
+			stopAndWait();
+			size_t valuePos = line.find(" value ");
+			if (valuePos != string::npos) {
+				setOption(line.substr(15, valuePos - 15), line.substr(valuePos + 7));
+			}
+		}
 
-		else if (line.substr(0, 3) == "go ") {
-			MoveGenerator generator(threads, depth, board);
-			Node* root = generator.createTree(turnColor);
+		else if (line == "go" || line.substr(0, 3) == "go ") {
+			stopAndWait();
+			const SearchLimits limits = parseGo(line);
+
+			// A book move is played at once, except in infinite and ponder mode where the GUI waits for stop.
+			Move bookMove;
+			if (!limits.infinite && !limits.ponder && Book::probe(board, turnColor, bookMove)) {
+				const string bestmovestr("bestmove " + Search::moveNotation(bookMove));
+				Logger::write(Logger::INFO, ">> " + bestmovestr);
+				cout << bestmovestr << endl;
+			}
+			else {
+				stopSearch = false;
+				pondering = limits.ponder;
+				searchThread = thread(&UCI::think, this, limits);
+			}
+		}
 
-			std::vector<Node*> bestMoves = root->getBestChildren();
+		else if (line.substr(0, 6) == "perft " || line.substr(0, 7) == "divide ") {
+			stopAndWait();
+			perft(line, board, turnColor);
+		}
 
-			// if bestMoves.size == 0, checkmate
+		else if (line.substr(0, 9) == "position ") {
+			stopAndWait();
+			setPosition(line);
+		}
 
-			unsigned int rnd = rand() % bestMoves.size();
-			Node *n = bestMoves[rnd];
+	}
 
-			unsigned int pos = n->fields.position;
-			unsigned int dest = n->fields.destination;
+	Logger::stop();
+}
 
-			std::string bestmovestr("bestmove " + chessengine::Board::squareNotation(pos) + chessengine::Board::squareNotation(dest));
+// Sets up the position of a "position startpos|fen <fen> [moves <move>...]" command. When the command repeats the
+// start position and moves of the previous one and adds moves, as GUIs send it during a game, only the added moves
+// are made.
+void UCI::setPosition(const string& line)
+{
+	istringstream tokens(line.substr(9));
+	string token, start;
+	vector<string> moves;
+
+	tokens >> token;
+	if (token == "startpos") {
+		start = token;
+		tokens >> token;
+	}
+	else if (token == "fen") {
+		while (tokens >> token && token != "moves") {
+			start += (start.empty() ? "" : " ") + token;
+		}
+	}
+	else {
+		return;
+	}
 
-			stream.open("log.txt", ios::app);
-			stream << bestmovestr << endl;
-			stream.close();
+	if (token == "moves") {
+		while (tokens >> token) {
+			moves.push_back(token);
+		}
+	}
+
+	const bool extends = start == positionStart && moves.size() >= positionMoves.size()
+		&& equal(positionMoves.begin(), positionMoves.end(), moves.begin());
+
+	if (!extends) {
+		if (start == "startpos") {
+			board = Board();
+			board.init();
+			turnColor = Board::WHITE;
+		}
+		else {
+			board = createBoardFromFen(start, turnColor);
+		}
+		positionStart = start;
+		positionMoves.clear();
+	}
 
-			delete root;
+	for (size_t i = positionMoves.size(); i < moves.size(); i++) {
+		MoveList legal;
+		MoveGenerator::generateMoves(board, turnColor, legal);
 
-			cout << bestmovestr << endl;
+		const Move *move = find_if(legal.begin(), legal.end(), [&](const Move& m) { return Search::moveNotation(m) == moves[i]; });
+		if (move == legal.end()) {
+			cout << "info string illegal move " << moves[i] << endl;
+			Logger::write(Logger::WARNING, "illegal move " + moves[i] + " in " + line);
+			break;
 		}
 
-		else if (line.substr(0, 13) == "position fen ") {
-			string fenstr = line.substr(13);
-			board = createBoardFromFen(fenstr, turnColor);
+		board.makeMove(*move, turnColor);
+		turnColor ^= Board::BLACK;
+		positionMoves.push_back(moves[i]);
+
+		// Only the moves since the last capture or pawn move are needed for repetitions. They are dropped while
+		// replaying, so that a game longer than the history, followed by a search, does not overflow it.
+		if (board.halfmoveClock() == 0 || board.historyLength() >= Board::MAX_HISTORY - Search::MAX_PLY)
+			board.trimHistory();
+	}
+
+	board.trimHistory();
+}
+
+// Parses the limits of a go command. Without any limit, the depth given on the command line is used.
+SearchLimits UCI::parseGo(const string& line)
+{
+	SearchLimits limits;
+	istringstream tokens(line.substr(2));
+	string token;
+
+	while (tokens >> token) {
+		if (token == "wtime") tokens >> limits.time[Board::WHITE / Board::BLACK];
+		else if (token == "btime") tokens >> limits.time[Board::BLACK / Board::BLACK];
+		else if (token == "winc") tokens >> limits.inc[Board::WHITE / Board::BLACK];
+		else if (token == "binc") tokens >> limits.inc[Board::BLACK / Board::BLACK];
+		else if (token == "movestogo") tokens >> limits.movesToGo;
+		else if (token == "movetime") tokens >> limits.moveTime;
+		else if (token == "depth") tokens >> limits.depth;
+		else if (token == "nodes") tokens >> limits.nodes;
+		else if (token == "infinite") limits.infinite = true;
+		else if (token == "ponder") limits.ponder = true;
+	}
+
+	if (!limits.timed() && !limits.infinite && limits.depth == 0 && limits.nodes == 0) {
+		limits.depth = depth;
+	}
+
+	return limits;
+}
+
+// Searches the current position and prints the best move, and the expected reply to ponder on. Runs on the search
+// thread. In infinite mode, and while pondering, the best move is held back until the GUI sends stop or ponderhit.
+void UCI::think(SearchLimits limits)
+{
+	while (pawnTables.size() < (threads > 0 ? threads : 1)) {
+		pawnTables.push_back(new PawnTable());
+	}
+
+	ParallelSearch search(board, turnColor, table, pawnTables, threads);
+	search.reportTo(cout);
+	table.newSearch();
+	search.run(limits, stopSearch, &pondering);
+
+	while ((limits.infinite || pondering) && !stopSearch) {
+		this_thread::sleep_for(chrono::milliseconds(1));
+	}
+
+	// no legal moves => checkmate or stalemate
+	string bestmovestr("bestmove " + (search.mainSearch().hasBestMove() ? Search::moveNotation(search.mainSearch().bestMove()) : string("0000")));
+
+	Move pv[Search::MAX_PLY];
+	if (search.mainSearch().principalVariation(pv) >= 2) {
+		bestmovestr += " ponder " + Search::moveNotation(pv[1]);
+	}
+
+	Logger::write(Logger::INFO, ">> " + bestmovestr);
+
+	cout << bestmovestr + "\n";
+}
+
+// Stops a running search and waits for it to print its best move.
+void UCI::stopAndWait()
+{
+	if (searchThread.joinable()) {
+		stopSearch = true;
+		searchThread.join();
+	}
+	pondering = false;
+}
+
+void UCI::setOption(const string& name, const string& value)
+{
+	unsigned long n;
+
+	if (name == "Hash") {
+		if (parseNumber(value, n)) {
+			table.resize(n);
+		}
+		else {
+			cout << "info string invalid value " << value << endl;
+		}
+	}
+	else if (name == "Threads") {
+		if (parseNumber(value, n)) {
+			threads = n < 1 ? 1 : n > MAX_THREADS ? MAX_THREADS : (unsigned int)n;
+		}
+		else {
+			cout << "info string invalid value " << value << endl;
+		}
+	}
+	else if (name == "EvalFile") {
+		// Without a network, the handcrafted evaluation is used.
+		if (value.empty() || value == "<empty>") {
+			Nnue::unload();
+		}
+		else if (Nnue::load(value)) {
+			cout << "info string loaded network " << value << endl;
+		}
+		else {
+			cout << "info string failed to load network " << value << endl;
+		}
+	}
+	else if (name == "UseNNUE") {
+		Nnue::setEnabled(value == "true");
+	}
+	else if (name == "Ponder") {
+		// Only tells that the GUI may send go ponder, which needs no preparation.
+	}
+	else if (name == "OwnBook") {
+		Book::setEnabled(value == "true");
+	}
+	else if (name == "BookFile") {
+		if (value.empty() || value == "<empty>") {
+			Book::unload();
+		}
+		else if (Book::load(value)) {
+			cout << "info string loaded book " << value << endl;
+		}
+		else {
+			cout << "info string failed to load book " << value << endl;
 		}
+	}
+	else if (name == "SyzygyPath") {
+		const unsigned int found = Syzygy::init(value == "<empty>" ? "" : value);
+		cout << "info string found " << found << " tablebases" << endl;
+	}
+	else if (name == "SyzygyProbeLimit") {
+		if (parseNumber(value, n)) {
+			Syzygy::setProbeLimit((unsigned int)n);
+		}
+		else {
+			cout << "info string invalid value " << value << endl;
+		}
+	}
+}
+
+// Parses an option value that must be a whole non-negative number, with nothing after it.
+bool UCI::parseNumber(const string& value, unsigned long& number)
+{
+	istringstream tokens(value);
+	string rest;
+	return !value.empty() && value[0] != '-' && (tokens >> number) && !(tokens >> rest);
+}
+
+// Runs one of the move generator tests: "perft <depth> [fen]", "divide <depth> [fen]" or "perft suite [depth]".
+// Without a fen, the given position is used. Returns false if the suite finds a wrong count.
+bool UCI::perft(const string& line, Board board, color turn)
+{
+	istringstream tokens(line);
+	string command, argument;
+	tokens >> command >> argument;
+
+	if (argument == "suite") {
+		unsigned int depth = 5;
+		tokens >> depth;
+		return Perft::runSuite(depth, cout);
+	}
+
+	unsigned long depth;
+	if (!parseNumber(argument, depth)) {
+		cout << "info string invalid depth " << argument << endl;
+		return false;
+	}
+
+	string fen;
+	getline(tokens >> ws, fen);
 
+	if (!fen.empty()) {
+		board = createBoardFromFen(fen, turn);
 	}
 
+	Perft::run(board, turn, depth, command == "divide", cout);
+	return true;
 }
 
 Board UCI::createBoardFromFen(const string& fenstr, color& activeColor)
@@ -89,8 +371,27 @@ Board UCI::createBoardFromFen(const string& fenstr, color& activeColor)
 		char ch = *it;
 
 		if (ch == ' ') {
-			it++; // iterate to active color
-			activeColor = (*it == 'w' || *it == 'W') ? Board::WHITE : Board::BLACK;
+			// active color, castling availability, en passant target square and halfmove clock
+			istringstream fields(string(it + 1, fenstr.end()));
+			string active, castling, enPassant;
+			unsigned int halfmoves = 0;
+			fields >> active >> castling >> enPassant >> halfmoves;
+
+			activeColor = (active == "w" || active == "W") ? Board::WHITE : Board::BLACK;
+
+			uint8_t rights = 0;
+			for (char c : castling) {
+				if (c == 'K') rights |= Board::WHITE_KINGSIDE;
+				else if (c == 'Q') rights |= Board::WHITE_QUEENSIDE;
+				else if (c == 'k') rights |= Board::BLACK_KINGSIDE;
+				else if (c == 'q') rights |= Board::BLACK_QUEENSIDE;
+			}
+			board.setCastlingRights(rights);
+
+			if (enPassant.size() == 2 && enPassant[0] >= 'a' && enPassant[0] <= 'h') {
+				board.setEnPassant((enPassant[1] - '1') * 8 + (enPassant[0] - 'a'));
+			}
+			board.setHalfmoveClock(halfmoves);
 			break;
 		}
 		if (ch == '/') {
@@ -1,6 +1,12 @@
 #pragma once
 #include "Board.h"
+#include "TranspositionTable.h"
+#include "PawnTable.h"
+#include "TimeManager.h"
 #include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
 
 class UCI
 {
@@ -10,12 +16,33 @@ public:
 	~UCI();
 
 	void start();
-	chessengine::Board createBoardFromFen(const std::string& fenstr, chessengine::color& activeColor);
+	static chessengine::Board createBoardFromFen(const std::string& fenstr, chessengine::color& activeColor);
+	static bool perft(const std::string& line, chessengine::Board board, chessengine::color turn);
 
 private:
+	static const unsigned int MAX_THREADS = 256;
+
 	chessengine::color turnColor;
 	chessengine::Board board;
+
+	// Start position ("startpos" or a fen) and moves of the last position command, which the next one may extend.
+	std::string positionStart;
+	std::vector<std::string> positionMoves;
+	chessengine::TranspositionTable table;
+	std::vector<chessengine::PawnTable*> pawnTables;	// One per search thread, kept across searches.
 	unsigned int threads;
 	unsigned int depth;
 
+	// The search runs on its own thread, so that stop can be received while searching.
+	std::thread searchThread;
+	std::atomic<bool> stopSearch;
+	std::atomic<bool> pondering;	// Set by go ponder, cleared by ponderhit.
+
+	void setPosition(const std::string& line);
+	chessengine::SearchLimits parseGo(const std::string& line);
+	void think(chessengine::SearchLimits limits);
+	void stopAndWait();
+	void setOption(const std::string& name, const std::string& value);
+	static bool parseNumber(const std::string& value, unsigned long& number);
+
 };
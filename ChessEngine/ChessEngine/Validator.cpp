@@ -1,50 +1,31 @@
 #include "Validator.h"
+#include "PieceSquareTables.h"
+#include <algorithm>
 
-
+// Evaluation in centipawns, white-relative, with the pawn structure evaluated from scratch.
 short Validator::validate(const Board & board)
 {
-	long score = 0;
-	score += pieceScore(board) * 1;// +posScore(board);
-	return (short)score;
+	PawnTable::Entry pawnEntry;
+	PawnTable::evaluate(board, pawnEntry);
+	return taper(board, pawnEntry);
 }
 
-
-long Validator::pieceScore(const Board & board)
+// Evaluation in centipawns, white-relative, with the pawn structure taken from a pawn table.
+short Validator::validate(const Board & board, PawnTable & pawns)
 {
-	long score = 0;
-
-	for (piece_t t = Board::PAWN; t <= Board::QUEEN; t++)
-	{
-		score += (bitcount(board.bitboard[t + Board::WHITE]) - bitcount(board.bitboard[t + Board::BLACK])) * Board::PIECE_VALUE[t];
-	}
-
-	return score;
+	return taper(board, pawns.probe(board));
 }
 
-
-long Validator::posScore(const Board & board)
+// Tapered evaluation: the middlegame and endgame scores of the material and piece placement, which the board keeps
+// up to date, and of the pawn structure are blended by the game phase.
+short Validator::taper(const Board & board, PawnTable::Entry & pawnEntry)
 {
-	long score = 0;
-
-	posScoreHelper(board.bitboard[Board::BLACK + Board::PAWN], score);
-	posScoreHelper(board.bitboard[Board::BLACK + Board::ROOK], score);
-	posScoreHelper(board.bitboard[Board::BLACK + Board::KNIGHT], score);
-	posScoreHelper(board.bitboard[Board::BLACK + Board::BISHOP], score);
-	posScoreHelper(board.bitboard[Board::BLACK + Board::QUEEN], score);
+	const int midgame = board.midgameScore() + pawnEntry.midgame
+		+ PawnTable::shelter(board, pawnEntry, Board::WHITE) - PawnTable::shelter(board, pawnEntry, Board::BLACK);
+	const int endgame = board.endgameScore() + pawnEntry.endgame;
 
-	score *= -1;
+	const int phase = std::min<int>(board.gamePhase(), PieceSquareTables::MAX_PHASE);
+	const long score = (long)midgame * phase + (long)endgame * (PieceSquareTables::MAX_PHASE - phase);
 
-	posScoreHelper(board.bitboard[Board::WHITE + Board::PAWN], score);
-	posScoreHelper(board.bitboard[Board::WHITE + Board::ROOK], score);
-	posScoreHelper(board.bitboard[Board::WHITE + Board::KNIGHT], score);
-	posScoreHelper(board.bitboard[Board::WHITE + Board::BISHOP], score);
-	posScoreHelper(board.bitboard[Board::WHITE + Board::QUEEN], score);
-
-	return score;
-}
-
-
-void Validator::posScoreHelper(uint64_t p_typePosMask, long &out)
-{
-	for (uint64_t mask : PIECE_POS_SCORE_MASK) out += bitcount(mask & p_typePosMask);
+	return (short)(score / PieceSquareTables::MAX_PHASE);
 }
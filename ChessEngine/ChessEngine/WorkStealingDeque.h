@@ -0,0 +1,52 @@
+#pragma once
+#include <deque>
+#include <mutex>
+#include "Node.h"
+
+namespace chessengine
+{
+
+	// Subtrees waiting to be expanded, owned by one worker thread of the tree generation.
+	// The owner pushes and pops at the back, so it continues with the subtrees it split last, which are the
+	// smallest. Other workers steal from the front, where the largest subtrees are.
+	class WorkStealingDeque
+	{
+
+	public:
+
+		void push(Node *node)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			nodes.push_back(node);
+		}
+
+		bool pop(Node *&node)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (nodes.empty())
+				return false;
+
+			node = nodes.back();
+			nodes.pop_back();
+			return true;
+		}
+
+		bool steal(Node *&node)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (nodes.empty())
+				return false;
+
+			node = nodes.front();
+			nodes.pop_front();
+			return true;
+		}
+
+	private:
+
+		std::deque<Node*> nodes;
+		std::mutex mutex;
+
+	};
+
+}
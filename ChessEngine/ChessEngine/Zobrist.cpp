@@ -0,0 +1,38 @@
+#include "Zobrist.h"
+
+using namespace chessengine;
+
+// SplitMix64 step, a simple generator with well distributed output.
+static constexpr uint64_t splitMix64(uint64_t &state)
+{
+	state += 0x9E3779B97F4A7C15ui64;
+	uint64_t z = state;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ui64;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBui64;
+	return z ^ (z >> 31);
+}
+
+static constexpr Zobrist::Keys generateKeys()
+{
+	Zobrist::Keys keys = {};
+	uint64_t state = 0x42F0E1EBA9EA3693ui64;
+
+	for (int piece = 0; piece < 12; piece++)
+		for (int pos = 0; pos < 64; pos++)
+			keys.piece[piece][pos] = splitMix64(state);
+
+	keys.blackToMove = splitMix64(state);
+
+	// keys.castling[0] stays 0, positions without castling rights add no castling key.
+	for (int rights = 1; rights < 16; rights++)
+		keys.castling[rights] = splitMix64(state);
+
+	for (int f = 0; f < 8; f++)
+		keys.enPassant[f] = splitMix64(state);
+
+	return keys;
+}
+
+static constexpr Zobrist::Keys ZOBRIST_KEYS = generateKeys();
+
+const Zobrist::Keys Zobrist::KEYS = ZOBRIST_KEYS;
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+
+namespace chessengine
+{
+
+	// Random keys for Zobrist hashing of board positions. Generated at compile time.
+	class Zobrist
+	{
+
+	public:
+
+		struct Keys
+		{
+			uint64_t piece[12][64];	// Indexed by piece (color + type) and square.
+			uint64_t blackToMove;	// Toggled when black is to move.
+			uint64_t castling[16];	// Indexed by the set of castling rights.
+			uint64_t enPassant[8];	// Indexed by the file of the en passant square.
+		};
+
+		static const Keys KEYS;
+
+	};
+
+}
@@ -14,6 +14,10 @@
 #include "Validator.h"
 #include "MinMax.h"
 #include "UCI.h"
+#include "SlidingAttacks.h"
+#include "Nnue.h"
+#include "Syzygy.h"
+#include "BookBuilder.h"
 
 using namespace std;
 using namespace chessengine;
@@ -120,32 +124,32 @@ void computergame(unsigned int thread_count, unsigned int depth)
 	Board board;
 	board.init();
 	color turn = Board::WHITE;
+	TranspositionTable table;
 
 	board.printFull();
 
 	while (1)
 	{
-		MoveGenerator generator(thread_count, depth, board);
+		MoveGenerator generator(thread_count, depth, board, table);
 		Node *root = generator.createTree(turn);
 
 		std::vector<Node*> bestMoves = root->getBestChildren();
 		if (bestMoves.size() == 0)
 		{
 			// checkmate
-			delete root;
 			break;
 		}
 
 		unsigned int rnd = rand() % bestMoves.size();
 		Node *n = bestMoves[rnd];
 
-		unsigned int pos = n->fields.position;
-		unsigned int dest = n->fields.destination;
-		piece_t t = n->fields.piece_t;
+		unsigned int pos = n->move.pos();
+		unsigned int dest = n->move.dest();
+		piece_t t = board.pieceType(pos);
 
 		//system("pause");
 		system("cls");
-		board.movePiece(pos, t, turn, dest);
+		board.movePiece(n->move, turn);
 		board.printFull();
 		cout << squareNotation(pos) << " " << Board::PIECE_NAME[t] << " to " << squareNotation(dest) << endl;
 		
@@ -153,8 +157,6 @@ void computergame(unsigned int thread_count, unsigned int depth)
 		cout << "Board value: " << boardVal << (boardVal > 0 ? " WHITE" : (boardVal < 0 ? " BLACK" : " EVEN")) << endl;
 
 		turn ^= Board::BLACK;
-
-		delete root;
 	}
 }
 
@@ -166,8 +168,9 @@ void test(unsigned int thread_count, unsigned int depth)
 	board.init(); // init pieces
 
 	color turn = white;
+	TranspositionTable table;
 
-	MoveGenerator generator(thread_count, depth, board);
+	MoveGenerator generator(thread_count, depth, board, table);
 	Node *root = generator.createTree(turn);
 
 	std::vector<Node*> bestMoves = root->getBestChildren();
@@ -177,7 +180,6 @@ void test(unsigned int thread_count, unsigned int depth)
 	if (bestMoves.size() == 0)
 	{
 		// checkmate
-		delete root;
 		return;
 	}
 
@@ -185,15 +187,12 @@ void test(unsigned int thread_count, unsigned int depth)
 	{
 		Node *n = *it;
 
-		unsigned int pos = n->fields.position;
-		unsigned int dest = n->fields.destination;
-		piece_t t = n->fields.piece_t;
+		unsigned int pos = n->move.pos();
+		unsigned int dest = n->move.dest();
+		piece_t t = board.pieceType(pos);
 
 		cout << squareNotation(pos) << " " << Board::PIECE_NAME[t] << " to " << squareNotation(dest) << endl;
 	}
-	
-
-	delete root;
 }
 
 
@@ -206,8 +205,49 @@ void play(unsigned int thread_count, unsigned int depth) {
 int main(int argc, char** argv)
 {
 	int thread_count = 16;
-	int depth = 5; // TODO: 5 = OK, 6 = HASSARD. must be a bug somewhere
+	int depth = 7; // alpha-beta search depth. The full tree of test() and computergame() is only practical up to 5
+
+	SlidingAttacks::init();
+	Nnue::init();
+
+	// move generator test mode: perft <depth> [fen], divide <depth> [fen] or perft suite [depth]
+	if (argc > 2 && (string(argv[1]) == "perft" || string(argv[1]) == "divide")) {
+		string line = argv[1];
+		for (int i = 2; i < argc; i++) {
+			line += string(" ") + argv[i];
+		}
+
+		Board board;
+		board.init();
+		return UCI::perft(line, board, Board::WHITE) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
 
+	// tablebase test mode: syzygy <path>, probes positions with known results
+	if (argc > 2 && string(argv[1]) == "syzygy") {
+		cout << "found " << Syzygy::init(argv[2]) << " tablebases" << endl;
+		return Syzygy::runSuite(cout) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	// book key test mode: book keys, checks the Polyglot keys of known positions, read and written by the builder
+	if (argc == 3 && string(argv[1]) == "book" && string(argv[2]) == "keys") {
+		const bool passed = Book::runSuite(cout);
+		cout << endl;
+		return BookBuilder::runSuite(cout) && passed ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	// opening book mode: book <output.bin> <games.pgn> [more.pgn ...]
+	if (argc > 3 && string(argv[1]) == "book") {
+		BookBuilder builder(std::thread::hardware_concurrency());
+		for (int i = 3; i < argc; i++) {
+			if (!builder.addFile(argv[i])) {
+				cout << "cannot read " << argv[i] << endl;
+				return EXIT_FAILURE;
+			}
+		}
+
+		cout << builder.gameCount() << " games added, " << builder.skippedCount() << " skipped" << endl;
+		return builder.write(argv[2]) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
 
 	// first argument: number of threads
 	if (argc > 1) {